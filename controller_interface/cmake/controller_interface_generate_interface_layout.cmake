@@ -0,0 +1,71 @@
+# Copyright 2020 Open Source Robotics Foundation, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+#
+# Generates the static interface layout of a robot description for a target.
+#
+# The ros2_control tags of the robot description are parsed at build time
+# with parse_control_resources_from_urdf, and a header is generated with, for
+# each hardware, the constexpr index of each of its interfaces in the
+# InterfaceRegistry, a struct laid out like the registry values, copied out of
+# the registry by load_values(), and a function registering the interfaces in
+# that order. The header is regenerated when the robot description changes and
+# is included as "<NAMESPACE>/interface_layout.hpp".
+#
+# Command interfaces are named after their state counterpart with a
+# "_command" suffix, like in the shared memory transport.
+#
+# :param target: the library or executable using the layout
+# :type target: string
+# :param URDF: the robot description file
+# :type URDF: string
+# :param NAMESPACE: the namespace of the layout, defaults to the target name
+# :type NAMESPACE: string
+#
+# @public
+#
+function(controller_interface_generate_interface_layout target)
+  cmake_parse_arguments(ARG "" "URDF;NAMESPACE" "" ${ARGN})
+  if(ARG_UNPARSED_ARGUMENTS)
+    message(FATAL_ERROR "controller_interface_generate_interface_layout() called with "
+      "unused arguments: ${ARG_UNPARSED_ARGUMENTS}")
+  endif()
+  if(NOT ARG_URDF)
+    message(FATAL_ERROR "controller_interface_generate_interface_layout() requires a URDF")
+  endif()
+  if(NOT ARG_NAMESPACE)
+    set(ARG_NAMESPACE "${target}")
+  endif()
+  get_filename_component(urdf "${ARG_URDF}" ABSOLUTE)
+
+  if(TARGET generate_interface_layout)
+    set(generator "$<TARGET_FILE:generate_interface_layout>")
+  else()
+    set(generator "${controller_interface_INTERFACE_LAYOUT_GENERATOR}")
+  endif()
+
+  set(include_dir "${CMAKE_CURRENT_BINARY_DIR}/${target}_interface_layout")
+  set(header "${include_dir}/${ARG_NAMESPACE}/interface_layout.hpp")
+  add_custom_command(
+    OUTPUT "${header}"
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${include_dir}/${ARG_NAMESPACE}"
+    COMMAND "${generator}" "${urdf}" "${header}" "${ARG_NAMESPACE}"
+    DEPENDS "${urdf}" "${generator}"
+    COMMENT "Generating the interface layout of ${ARG_URDF}"
+    VERBATIM
+  )
+  add_custom_target("${target}_interface_layout" DEPENDS "${header}")
+  add_dependencies("${target}" "${target}_interface_layout")
+  target_include_directories("${target}" PUBLIC "$<BUILD_INTERFACE:${include_dir}>")
+endfunction()
@@ -0,0 +1,19 @@
+# Copyright 2020 Open Source Robotics Foundation, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# copied into controller_interfaceConfig.cmake, next to the installed cmake files
+set(controller_interface_INTERFACE_LAYOUT_GENERATOR
+  "${controller_interface_DIR}/../../../lib/controller_interface/generate_interface_layout")
+include("${controller_interface_DIR}/controller_interface_configure_controller_library.cmake")
+include("${controller_interface_DIR}/controller_interface_generate_interface_layout.cmake")
@@ -51,18 +51,139 @@ public:
     std::weak_ptr<hardware_interface::RobotHardware> robot_hardware,
     const std::string & controller_name);
 
+  /// Initialize the controller without a dedicated lifecycle node.
+  /**
+   * In this lightweight mode the lifecycle is driven by a minimal in-process state machine
+   * and parameters live on the node given by \p shared_parameters. Their names aren't prefixed
+   * for the controller, it should declare them as `<controller_name>.<parameter>`, the same way
+   * the controller manager stores `<controller_name>.type`.
+   * No lifecycle node is ever created, a plain node is created once the controller calls
+   * get_node(), which should be done from on_configure() if the controller needs topics.
+   * \param robot_hardware The hardware the controller will be working on.
+   * \param controller_name The name of the controller.
+   * \param shared_parameters The parameters interface of the hosting node.
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  virtual
+  return_type
+  init(
+    std::weak_ptr<hardware_interface::RobotHardware> robot_hardware,
+    const std::string & controller_name,
+    rclcpp::node_interfaces::NodeParametersInterface::SharedPtr shared_parameters);
+
   CONTROLLER_INTERFACE_PUBLIC
   virtual
   return_type
   update() = 0;
 
+  /// Get the lifecycle node of the controller, nullptr in lightweight mode.
   CONTROLLER_INTERFACE_PUBLIC
   std::shared_ptr<rclcpp_lifecycle::LifecycleNode>
   get_lifecycle_node();
 
+  /// Return true if a lifecycle node has been created for this controller.
+  CONTROLLER_INTERFACE_PUBLIC
+  bool
+  has_lifecycle_node() const;
+
+  /// Get the node of a lightweight controller, for its topics and services.
+  /**
+   * The node is created on first use, without parameter services nor lifecycle services
+   * and publishers. It is added to an executor by the controller manager once the controller
+   * is configured or started, so it shouldn't be created from update().
+   * \return nullptr if the controller isn't lightweight, use get_lifecycle_node() instead.
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  std::shared_ptr<rclcpp::Node>
+  get_node();
+
+  /// Base interface of the node created for this controller, if any, to spin it.
+  CONTROLLER_INTERFACE_PUBLIC
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr
+  get_node_base_interface() const;
+
+  CONTROLLER_INTERFACE_PUBLIC
+  bool
+  is_lightweight() const;
+
+  CONTROLLER_INTERFACE_PUBLIC
+  const std::string &
+  get_name() const;
+
+  /// Parameters interface the controller should declare its parameters on.
+  /**
+   * In lightweight mode, this is the interface of the hosting node, shared by every
+   * lightweight controller, so parameter names must start with get_name() and a dot.
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  rclcpp::node_interfaces::NodeParametersInterface::SharedPtr
+  get_parameters_interface();
+
+  CONTROLLER_INTERFACE_PUBLIC
+  const rclcpp_lifecycle::State &
+  get_current_state() const;
+
+  CONTROLLER_INTERFACE_PUBLIC
+  const rclcpp_lifecycle::State &
+  configure();
+
+  CONTROLLER_INTERFACE_PUBLIC
+  const rclcpp_lifecycle::State &
+  cleanup();
+
+  CONTROLLER_INTERFACE_PUBLIC
+  const rclcpp_lifecycle::State &
+  activate();
+
+  CONTROLLER_INTERFACE_PUBLIC
+  const rclcpp_lifecycle::State &
+  deactivate();
+
+  /// Time of the control cycle being updated.
+  /**
+   * Set by the controller manager before every update(), from its clock or from the
+   * simulated clock when it is stepped, so controllers should use it instead of reading a clock.
+   */
+  CONTROLLER_INTERFACE_PUBLIC
+  const rclcpp::Time &
+  get_update_time() const;
+
+  /// Time elapsed since the previous cycle of the controller manager, zero on the first one.
+  CONTROLLER_INTERFACE_PUBLIC
+  const rclcpp::Duration &
+  get_update_period() const;
+
+  CONTROLLER_INTERFACE_PUBLIC
+  void
+  set_update_time(const rclcpp::Time & time, const rclcpp::Duration & period);
+
 protected:
   std::weak_ptr<hardware_interface::RobotHardware> robot_hardware_;
   std::shared_ptr<rclcpp_lifecycle::LifecycleNode> lifecycle_node_;
+
+private:
+  using TransitionCallback =
+    CallbackReturn (ControllerInterface::*)(const rclcpp_lifecycle::State &);
+
+  const rclcpp_lifecycle::State &
+  lightweight_transition(
+    std::uint8_t start_state_id,
+    const rclcpp_lifecycle::State & goal_state,
+    TransitionCallback callback);
+
+  std::string controller_name_;
+  bool lightweight_ = false;
+  std::shared_ptr<rclcpp::Node> node_;
+  rclcpp::node_interfaces::NodeParametersInterface::SharedPtr shared_parameters_;
+  rclcpp::Time update_time_;
+  rclcpp::Duration update_period_ {0, 0};
+
+  // States of the in-process state machine, built once so transitions don't allocate
+  rclcpp_lifecycle::State unconfigured_state_;
+  rclcpp_lifecycle::State inactive_state_;
+  rclcpp_lifecycle::State active_state_;
+  rclcpp_lifecycle::State finalized_state_;
+  const rclcpp_lifecycle::State * current_state_ = &unconfigured_state_;
 };
 
 using ControllerInterfaceSharedPtr = std::shared_ptr<ControllerInterface>;
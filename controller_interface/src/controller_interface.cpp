@@ -17,6 +17,8 @@
 #include <memory>
 #include <string>
 
+#include "lifecycle_msgs/msg/state.hpp"
+
 namespace controller_interface
 {
 
@@ -26,6 +28,9 @@ ControllerInterface::init(
   const std::string & controller_name)
 {
   robot_hardware_ = robot_hardware;
+  controller_name_ = controller_name;
+  lightweight_ = false;
+  node_.reset();
   lifecycle_node_ = std::make_shared<rclcpp_lifecycle::LifecycleNode>(controller_name);
 
   lifecycle_node_->register_on_configure(
@@ -49,10 +54,183 @@ ControllerInterface::init(
   return return_type::SUCCESS;
 }
 
+return_type
+ControllerInterface::init(
+  std::weak_ptr<hardware_interface::RobotHardware> robot_hardware,
+  const std::string & controller_name,
+  rclcpp::node_interfaces::NodeParametersInterface::SharedPtr shared_parameters)
+{
+  robot_hardware_ = robot_hardware;
+  controller_name_ = controller_name;
+  lightweight_ = true;
+  shared_parameters_ = shared_parameters;
+  lifecycle_node_.reset();
+  node_.reset();
+
+  unconfigured_state_ = rclcpp_lifecycle::State(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_UNCONFIGURED, "unconfigured");
+  inactive_state_ = rclcpp_lifecycle::State(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE, "inactive");
+  active_state_ = rclcpp_lifecycle::State(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE, "active");
+  finalized_state_ = rclcpp_lifecycle::State(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_FINALIZED, "finalized");
+  current_state_ = &unconfigured_state_;
+
+  return return_type::SUCCESS;
+}
+
 std::shared_ptr<rclcpp_lifecycle::LifecycleNode>
 ControllerInterface::get_lifecycle_node()
 {
   return lifecycle_node_;
 }
 
+bool
+ControllerInterface::has_lifecycle_node() const
+{
+  return lifecycle_node_ != nullptr;
+}
+
+std::shared_ptr<rclcpp::Node>
+ControllerInterface::get_node()
+{
+  if (lightweight_ && !node_) {
+    // Parameters are served by the hosting node, only topics are needed here
+    rclcpp::NodeOptions node_options;
+    node_options.start_parameter_services(false);
+    node_options.start_parameter_event_publisher(false);
+    node_ = std::make_shared<rclcpp::Node>(controller_name_, node_options);
+  }
+  return node_;
+}
+
+rclcpp::node_interfaces::NodeBaseInterface::SharedPtr
+ControllerInterface::get_node_base_interface() const
+{
+  if (lifecycle_node_) {
+    return lifecycle_node_->get_node_base_interface();
+  }
+  if (node_) {
+    return node_->get_node_base_interface();
+  }
+  return nullptr;
+}
+
+const std::string &
+ControllerInterface::get_name() const
+{
+  return controller_name_;
+}
+
+bool
+ControllerInterface::is_lightweight() const
+{
+  return lightweight_;
+}
+
+rclcpp::node_interfaces::NodeParametersInterface::SharedPtr
+ControllerInterface::get_parameters_interface()
+{
+  if (lightweight_) {
+    return shared_parameters_;
+  }
+  return lifecycle_node_->get_node_parameters_interface();
+}
+
+const rclcpp_lifecycle::State &
+ControllerInterface::get_current_state() const
+{
+  if (lightweight_) {
+    return *current_state_;
+  }
+  return lifecycle_node_->get_current_state();
+}
+
+const rclcpp_lifecycle::State &
+ControllerInterface::configure()
+{
+  if (lightweight_) {
+    return lightweight_transition(
+      lifecycle_msgs::msg::State::PRIMARY_STATE_UNCONFIGURED, inactive_state_,
+      &ControllerInterface::on_configure);
+  }
+  return lifecycle_node_->configure();
+}
+
+const rclcpp_lifecycle::State &
+ControllerInterface::cleanup()
+{
+  if (lightweight_) {
+    return lightweight_transition(
+      lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE, unconfigured_state_,
+      &ControllerInterface::on_cleanup);
+  }
+  return lifecycle_node_->cleanup();
+}
+
+const rclcpp_lifecycle::State &
+ControllerInterface::activate()
+{
+  if (lightweight_) {
+    return lightweight_transition(
+      lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE, active_state_,
+      &ControllerInterface::on_activate);
+  }
+  return lifecycle_node_->activate();
+}
+
+const rclcpp_lifecycle::State &
+ControllerInterface::deactivate()
+{
+  if (lightweight_) {
+    return lightweight_transition(
+      lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE, inactive_state_,
+      &ControllerInterface::on_deactivate);
+  }
+  return lifecycle_node_->deactivate();
+}
+
+const rclcpp::Time &
+ControllerInterface::get_update_time() const
+{
+  return update_time_;
+}
+
+const rclcpp::Duration &
+ControllerInterface::get_update_period() const
+{
+  return update_period_;
+}
+
+void
+ControllerInterface::set_update_time(const rclcpp::Time & time, const rclcpp::Duration & period)
+{
+  update_time_ = time;
+  update_period_ = period;
+}
+
+const rclcpp_lifecycle::State &
+ControllerInterface::lightweight_transition(
+  std::uint8_t start_state_id,
+  const rclcpp_lifecycle::State & goal_state,
+  TransitionCallback callback)
+{
+  // Same semantics as the rclcpp_lifecycle state machine, minus services and publishers:
+  // invalid transitions are ignored, FAILURE keeps the current state and
+  // ERROR goes through on_error()
+  if (current_state_->id() != start_state_id) {
+    return *current_state_;
+  }
+
+  const auto ret = (this->*callback)(*current_state_);
+  if (ret == CallbackReturn::SUCCESS) {
+    current_state_ = &goal_state;
+  } else if (ret == CallbackReturn::ERROR) {
+    current_state_ = on_error(*current_state_) == CallbackReturn::SUCCESS ?
+      &unconfigured_state_ : &finalized_state_;
+  }
+  return *current_state_;
+}
+
 }  // namespace controller_interface
@@ -0,0 +1,288 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generates a header with the static interface layout of each hardware of a robot description,
+// run at build time by controller_interface_generate_interface_layout().
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "hardware_interface/component_parser.hpp"
+#include "hardware_interface/hardware_info.hpp"
+
+namespace
+{
+// same suffix as the command interfaces of the shared memory transport and test hardware
+constexpr auto kCommandSuffix = "_command";
+
+struct LayoutEntry
+{
+  std::string ns;
+  std::string name;
+  std::string interface_name;
+};
+
+std::string to_identifier(const std::string & name)
+{
+  std::string identifier = name;
+  std::replace_if(
+    identifier.begin(), identifier.end(),
+    [](char c) {return !std::isalnum(static_cast<unsigned char>(c));}, '_');
+  if (identifier.empty() || std::isdigit(static_cast<unsigned char>(identifier[0]))) {
+    identifier.insert(0, "_");
+  }
+  return identifier;
+}
+
+std::string to_literal(const std::string & value)
+{
+  std::string literal = "\"";
+  for (const auto c : value) {
+    if (c == '"' || c == '\\') {
+      literal += '\\';
+    }
+    literal += c;
+  }
+  return literal + '"';
+}
+
+std::string to_upper(std::string name)
+{
+  std::transform(
+    name.begin(), name.end(), name.begin(),
+    [](unsigned char c) {return static_cast<char>(std::toupper(c));});
+  return name;
+}
+
+/// Interfaces of a component in layout order, states first and then commands
+std::vector<std::string> interface_names(const hardware_interface::ComponentInfo & component)
+{
+  std::vector<std::string> names;
+  for (const auto & interface : component.state_interfaces) {
+    names.push_back(interface.name);
+  }
+  for (const auto & interface : component.command_interfaces) {
+    names.push_back(interface.name + kCommandSuffix);
+  }
+  return names;
+}
+
+void write_components(
+  std::ostream & out, const std::string & ns, const std::string & group,
+  const std::vector<hardware_interface::ComponentInfo> & components,
+  std::vector<LayoutEntry> & entries)
+{
+  if (components.empty()) {
+    return;
+  }
+  out << "namespace " << group << "\n{\n";
+  std::unordered_set<std::string> component_identifiers;
+  for (const auto & component : components) {
+    const auto component_identifier = to_identifier(component.name);
+    if (!component_identifiers.insert(component_identifier).second) {
+      throw std::runtime_error("two " + group + " are named " + component_identifier);
+    }
+    out << "namespace " << component_identifier << "\n{\n";
+    std::unordered_set<std::string> identifiers;
+    for (const auto & interface_name : interface_names(component)) {
+      const auto identifier = to_identifier(interface_name);
+      if (!identifiers.insert(identifier).second) {
+        throw std::runtime_error(
+                "two interfaces of " + component.name + " are named " + identifier);
+      }
+      out << "constexpr std::size_t " << identifier << " = " << entries.size() << ";\n";
+      entries.push_back({ns, component.name, interface_name});
+    }
+    out << "}  // namespace " << component_identifier << "\n";
+  }
+  out << "}  // namespace " << group << "\n\n";
+}
+
+size_t interface_count(const std::vector<hardware_interface::ComponentInfo> & components)
+{
+  size_t count = 0;
+  for (const auto & component : components) {
+    count += component.state_interfaces.size() + component.command_interfaces.size();
+  }
+  return count;
+}
+
+void write_values_struct(
+  std::ostream & out, const std::string & group,
+  const std::vector<hardware_interface::ComponentInfo> & components)
+{
+  // empty structs would take a byte and shift the values after them
+  if (interface_count(components) == 0) {
+    return;
+  }
+  out << "  struct\n  {\n";
+  for (const auto & component : components) {
+    if (interface_names(component).empty()) {
+      continue;
+    }
+    out << "    struct\n    {\n";
+    for (const auto & interface_name : interface_names(component)) {
+      out << "      double " << to_identifier(interface_name) << ";\n";
+    }
+    out << "    } " << to_identifier(component.name) << ";\n";
+  }
+  out << "  } " << group << ";\n";
+}
+
+void write_hardware(std::ostream & out, const hardware_interface::HardwareInfo & hardware)
+{
+  const auto hardware_identifier = to_identifier(hardware.name);
+  if (interface_count(hardware.joints) + interface_count(hardware.sensors) == 0) {
+    out << "// " << hardware.name << " has no interfaces\n\n";
+    return;
+  }
+  out << "namespace " << hardware_identifier << "\n{\n";
+
+  std::vector<LayoutEntry> entries;
+  write_components(out, "InterfaceNamespace::JOINT", "joints", hardware.joints, entries);
+  write_components(out, "InterfaceNamespace::SENSOR", "sensors", hardware.sensors, entries);
+
+  out << "/// Number of values of the hardware\n";
+  out << "constexpr std::size_t kSize = " << entries.size() << ";\n\n";
+
+  out << "struct Interface\n{\n";
+  out << "  hardware_interface::InterfaceNamespace ns;\n";
+  out << "  const char * name;\n";
+  out << "  const char * interface_name;\n";
+  out << "};\n\n";
+  out << "/// Interfaces in layout order, their index is their offset in the registry\n";
+  out << "constexpr Interface kInterfaces[] = {\n";
+  for (const auto & entry : entries) {
+    out << "  {hardware_interface::" << entry.ns << ", " << to_literal(entry.name) << ", " <<
+      to_literal(entry.interface_name) << "},\n";
+  }
+  out << "};\n\n";
+
+  out << "/// A copy of the values of the registry, laid out as in the robot description\n";
+  out << "struct Values\n{\n";
+  write_values_struct(out, "joints", hardware.joints);
+  write_values_struct(out, "sensors", hardware.sensors);
+  out << "};\n";
+  out << "static_assert(sizeof(Values) == kSize * sizeof(double), \"Values has padding\");\n\n";
+
+  out << R"(/// Register all interfaces in layout order, into a registry that must be empty.
+inline hardware_interface::return_type register_interfaces(
+  hardware_interface::InterfaceRegistry & registry)
+{
+  if (registry.size() != 0) {
+    return hardware_interface::return_type::ERROR;
+  }
+  std::vector<hardware_interface::InterfaceRegistration> table;
+  for (std::size_t i = 0; i < kSize; ++i) {
+    table.push_back({kInterfaces[i].name, kInterfaces[i].interface_name, 0.0});
+    if (i + 1 == kSize || kInterfaces[i + 1].ns != kInterfaces[i].ns) {
+      if (registry.register_interfaces(kInterfaces[i].ns, table) !=
+        hardware_interface::return_type::OK)
+      {
+        return hardware_interface::return_type::ERROR;
+      }
+      table.clear();
+    }
+  }
+  return hardware_interface::return_type::OK;
+}
+
+/// Whether the registry has the layout, to check once before using the offsets.
+inline bool matches(const hardware_interface::InterfaceRegistry & registry)
+{
+  if (registry.size() != kSize) {
+    return false;
+  }
+  for (std::size_t i = 0; i < kSize; ++i) {
+    const auto & interface = kInterfaces[i];
+    if (registry.find(interface.ns, interface.name, interface.interface_name) != i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Copy of the values of a registry having the layout, from data() or get_snapshot().
+/// The values are written through their index, e.g. data()[joints::joint1::position_command].
+inline Values load_values(const double * values)
+{
+  Values copy;
+  std::memcpy(&copy, values, sizeof(Values));
+  return copy;
+}
+)";
+  out << "}  // namespace " << hardware_identifier << "\n\n";
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  if (argc != 4) {
+    std::cerr << "usage: " << argv[0] << " <robot description> <output header> <namespace>" <<
+      std::endl;
+    return 1;
+  }
+  const std::string description_path = argv[1];
+  const std::string header_path = argv[2];
+  const std::string ns = argv[3];
+
+  std::ifstream description_file(description_path);
+  if (!description_file) {
+    std::cerr << "cannot read " << description_path << std::endl;
+    return 1;
+  }
+  std::stringstream description;
+  description << description_file.rdbuf();
+
+  std::stringstream header;
+  const auto guard = to_upper(to_identifier(ns)) + "__INTERFACE_LAYOUT_HPP_";
+  header << "// Generated from " << description_path << ", do not edit.\n\n";
+  header << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+  header << "#include <cstddef>\n#include <cstring>\n#include <vector>\n\n";
+  header << "#include \"hardware_interface/interface_registry.hpp\"\n\n";
+  header << "namespace " << to_identifier(ns) << "\n{\n";
+  header << "namespace interface_layout\n{\n";
+  try {
+    std::unordered_set<std::string> hardware_identifiers;
+    for (const auto & hardware :
+      hardware_interface::parse_control_resources_from_urdf(description.str()))
+    {
+      if (!hardware_identifiers.insert(to_identifier(hardware.name)).second) {
+        throw std::runtime_error("two hardware are named " + to_identifier(hardware.name));
+      }
+      write_hardware(header, hardware);
+    }
+  } catch (const std::exception & e) {
+    std::cerr << description_path << ": " << e.what() << std::endl;
+    return 1;
+  }
+  header << "}  // namespace interface_layout\n";
+  header << "}  // namespace " << to_identifier(ns) << "\n\n";
+  header << "#endif  // " << guard << "\n";
+
+  std::ofstream header_file(header_path);
+  header_file << header.str();
+  if (!header_file) {
+    std::cerr << "cannot write " << header_path << std::endl;
+    return 1;
+  }
+  return 0;
+}
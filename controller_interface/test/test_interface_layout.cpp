@@ -0,0 +1,68 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "hardware_interface/interface_registry.hpp"
+// generated at build time from test/robot_with_sensor.urdf
+#include "test_layout/interface_layout.hpp"
+
+namespace hw = hardware_interface;
+namespace layout = test_layout::interface_layout::RobotWithSensor;
+using hw::InterfaceNamespace;
+
+TEST(TestInterfaceLayout, indices_follow_the_robot_description)
+{
+  static_assert(layout::kSize == 7, "joints and sensors are all laid out");
+  static_assert(layout::joints::joint1::position == 0, "states come first");
+  static_assert(layout::joints::joint1::velocity == 1, "in description order");
+  static_assert(layout::joints::joint1::position_command == 2, "then commands");
+  static_assert(layout::joints::joint2::position == 3, "joints follow each other");
+  static_assert(layout::sensors::tcp_fts_sensor::fz == 6, "sensors come last");
+  EXPECT_STREQ("position_command", layout::kInterfaces[2].interface_name);
+  EXPECT_EQ(InterfaceNamespace::SENSOR, layout::kInterfaces[5].ns);
+}
+
+TEST(TestInterfaceLayout, registered_interfaces_match_the_layout)
+{
+  hw::InterfaceRegistry registry;
+  ASSERT_EQ(hw::return_type::OK, layout::register_interfaces(registry));
+  EXPECT_TRUE(layout::matches(registry));
+  EXPECT_EQ(
+    layout::sensors::tcp_fts_sensor::fx,
+    registry.find(InterfaceNamespace::SENSOR, "tcp_fts_sensor", "fx"));
+  // the registry must be empty
+  EXPECT_EQ(hw::return_type::ERROR, layout::register_interfaces(registry));
+
+  registry.data()[layout::joints::joint2::position] = 1.5;
+  registry.data()[layout::sensors::tcp_fts_sensor::fz] = -9.81;
+  const auto values = layout::load_values(registry.data());
+  EXPECT_EQ(1.5, values.joints.joint2.position);
+  EXPECT_EQ(-9.81, values.sensors.tcp_fts_sensor.fz);
+}
+
+TEST(TestInterfaceLayout, registries_registered_otherwise_do_not_match)
+{
+  hw::InterfaceRegistry registry;
+  EXPECT_FALSE(layout::matches(registry));
+  ASSERT_EQ(
+    hw::return_type::OK, registry.register_interfaces(
+      InterfaceNamespace::JOINT,
+      {{"joint1", "velocity"}, {"joint1", "position"}, {"joint1", "position_command"},
+        {"joint2", "position"}, {"joint2", "position_command"}}));
+  ASSERT_EQ(
+    hw::return_type::OK, registry.register_interfaces(
+      InterfaceNamespace::SENSOR, {{"tcp_fts_sensor", "fx"}, {"tcp_fts_sensor", "fz"}}));
+  EXPECT_FALSE(layout::matches(registry));
+}
@@ -15,19 +15,32 @@
 #ifndef CONTROLLER_MANAGER__CONTROLLER_MANAGER_HPP_
 #define CONTROLLER_MANAGER__CONTROLLER_MANAGER_HPP_
 
+#include <array>
+#include <atomic>
+#include <future>
 #include <memory>
 #include <string>
+#include <thread>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include "controller_interface/controller_interface.hpp"
 
 #include "controller_manager/controller_spec.hpp"
+#include "controller_manager/controller_states_snapshot.hpp"
+#include "controller_manager/controller_type_catalogue.hpp"
+#include "controller_manager/perf_counters.hpp"
+#include "controller_manager/rate_group.hpp"
 #include "controller_manager/visibility_control.h"
+#include "controller_manager_msgs/msg/controller_event.hpp"
+#include "controller_manager_msgs/msg/controller_states.hpp"
 #include "controller_manager_msgs/srv/list_controllers.hpp"
+#include "controller_manager_msgs/srv/list_controller_statistics.hpp"
 #include "controller_manager_msgs/srv/list_controller_types.hpp"
 #include "controller_manager_msgs/srv/load_controller.hpp"
 #include "controller_manager_msgs/srv/reload_controller_libraries.hpp"
+#include "controller_manager_msgs/srv/step.hpp"
 #include "controller_manager_msgs/srv/switch_controller.hpp"
 #include "controller_manager_msgs/srv/unload_controller.hpp"
 
@@ -55,7 +68,7 @@ public:
 
   CONTROLLER_MANAGER_PUBLIC
   virtual
-  ~ControllerManager() = default;
+  ~ControllerManager();
 
   CONTROLLER_MANAGER_PUBLIC
   controller_interface::ControllerInterfaceSharedPtr
@@ -75,8 +88,26 @@ public:
   controller_interface::return_type unload_controller(
     const std::string & controller_name);
 
+  /**
+   * @brief get_loaded_controllers returns the controllers of the last published snapshot,
+   * without copying them nor locking the controller lists
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  ControllerSpecsConstSharedPtr get_loaded_controllers() const;
+
+  /**
+   * @brief get_controller_states_snapshot returns the last published snapshot of the loaded
+   * controllers and their states, without locking the controller lists
+   */
   CONTROLLER_MANAGER_PUBLIC
-  std::vector<ControllerSpec> get_loaded_controllers() const;
+  ControllerStatesSnapshotConstSharedPtr get_controller_states_snapshot() const;
+
+  /**
+   * @brief get_controller_type_catalogue returns the cached catalogue of controller types,
+   * rebuilt only when the controller libraries are reloaded
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  ControllerTypeCatalogueConstSharedPtr get_controller_type_catalogue() const;
 
   template<
     typename T,
@@ -94,6 +125,19 @@ public:
     return add_controller_impl(controller_spec);
   }
 
+  /**
+   * @brief reload_controller_libraries reloads the libraries of the given controller types only.
+   * Loaded controllers of these types are unloaded, their library is closed and opened again,
+   * and they are loaded again with the same name. The ones that were running are restarted,
+   * which requires \p force_kill. Controllers of other types are not affected.
+   * @see Documentation in controller_manager_msgs/ReloadControllerLibraries.srv
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type
+  reload_controller_libraries(
+    const std::vector<std::string> & controller_types,
+    bool force_kill);
+
   /**
    * @brief switch_controller Stops some controllers and others.
    * @see Documentation in controller_manager_msgs/SwitchController.srv
@@ -107,32 +151,99 @@ public:
     bool start_asap = WAIT_FOR_ALL_RESOURCES,
     const rclcpp::Duration & timeout = rclcpp::Duration(0, INFINITE_TIMEOUT));
 
+  /**
+   * @brief update takes the snapshot of the hardware values the caller just read, updates the
+   * running controllers of the default rate group, which are all of them unless rate groups
+   * were added, then enforces the command watchdog of the hardware so the caller can write it
+   * right away
+   */
   CONTROLLER_MANAGER_PUBLIC
   controller_interface::return_type
   update();
 
+  /**
+   * @brief init_perf_counters opens the perf counters of the default rate group for the
+   * calling thread, when the perf_counters parameter is set. Perf only counts the thread that
+   * opened the counters, so the thread calling update() calls it once before its first cycle,
+   * the updates of any other thread are not sampled.
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  void init_perf_counters();
+
+  /**
+   * @brief update_rate_group updates the running controllers of one rate group
+   * @warning Only one thread may update a given group
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type
+  update_rate_group(size_t rate_group);
+
+  /**
+   * @brief add_rate_group adds a group that controllers can be assigned to with the
+   * `<controller_name>.rate_group` parameter, before they are loaded.
+   * The group needs hardware of its own, so its thread never shares hardware with update().
+   * @return ERROR if the name is taken, there are too many groups, or groups are running,
+   * or the group has no hardware or would use the manager hardware
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type
+  add_rate_group(const RateGroupConfig & config);
+
+  /// Starts the thread of every rate group but the default one
+  CONTROLLER_MANAGER_PUBLIC
+  void start_rate_groups();
+
+  CONTROLLER_MANAGER_PUBLIC
+  void stop_rate_groups();
+
+  /**
+   * @brief step runs \p cycles control cycles in lockstep with a simulated clock, as fast as
+   * the CPU allows. Each cycle advances the simulated time by \p period, then reads, updates and
+   * writes the hardware of the default group and of every rate group whose period elapsed.
+   * Once stepped, the rate group threads can't be started anymore.
+   * A switch waits for the next steps to apply it, so the ~/step service must be served by a
+   * multi-threaded executor while a ~/switch_controller request waits.
+   * @warning Nothing else may call update() meanwhile
+   * @see Documentation in controller_manager_msgs/Step.srv
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  controller_interface::return_type
+  step(const rclcpp::Duration & period, size_t cycles = 1);
+
+  CONTROLLER_MANAGER_PUBLIC
+  rclcpp::Time get_simulated_time() const;
+
+  /// Throughput of the last step() call, in cycles per second of wall time
+  CONTROLLER_MANAGER_PUBLIC
+  double get_step_cycles_per_second() const;
+
 protected:
   CONTROLLER_MANAGER_PUBLIC
   controller_interface::ControllerInterfaceSharedPtr
   add_controller_impl(const ControllerSpec & controller);
 
   CONTROLLER_MANAGER_PUBLIC
-  void manage_switch();
+  void manage_switch(size_t rate_group);
 
   CONTROLLER_MANAGER_PUBLIC
-  void stop_controllers();
+  void stop_controllers(size_t rate_group);
 
   CONTROLLER_MANAGER_PUBLIC
-  void start_controllers();
+  void start_controllers(size_t rate_group);
 
   CONTROLLER_MANAGER_PUBLIC
-  void start_controllers_asap();
+  void start_controllers_asap(size_t rate_group);
 
   CONTROLLER_MANAGER_PUBLIC
   void list_controllers_srv_cb(
     const std::shared_ptr<controller_manager_msgs::srv::ListControllers::Request> request,
     std::shared_ptr<controller_manager_msgs::srv::ListControllers::Response> response);
 
+  CONTROLLER_MANAGER_PUBLIC
+  void list_controller_statistics_srv_cb(
+    const std::shared_ptr<controller_manager_msgs::srv::ListControllerStatistics::Request> request,
+    std::shared_ptr<controller_manager_msgs::srv::ListControllerStatistics::Response> response);
+
   CONTROLLER_MANAGER_PUBLIC
   void list_controller_types_srv_cb(
     const std::shared_ptr<controller_manager_msgs::srv::ListControllerTypes::Request> request,
@@ -148,6 +259,11 @@ protected:
     const std::shared_ptr<controller_manager_msgs::srv::ReloadControllerLibraries::Request> request,
     std::shared_ptr<controller_manager_msgs::srv::ReloadControllerLibraries::Response> response);
 
+  CONTROLLER_MANAGER_PUBLIC
+  void step_service_cb(
+    const std::shared_ptr<controller_manager_msgs::srv::Step::Request> request,
+    std::shared_ptr<controller_manager_msgs::srv::Step::Response> response);
+
   CONTROLLER_MANAGER_PUBLIC
   void switch_controller_service_cb(
     const std::shared_ptr<controller_manager_msgs::srv::SwitchController::Request> request,
@@ -161,9 +277,148 @@ protected:
 private:
   std::vector<std::string> get_controller_names();
 
+  /// Executor thread owned by the controller manager for a group of controllers.
+  struct ExecutorGroup
+  {
+    std::shared_ptr<rclcpp::Executor> executor;
+    std::thread thread;
+    std::promise<void> stop;
+    size_t node_count = 0;
+  };
+
+  /// Node of a controller added to an executor
+  struct ControllerNode
+  {
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node;
+    /// Empty for the executor given at construction
+    std::string executor_group;
+  };
+
+  /**
+   * @brief add_controller_to_executor adds the node of the controller, if it has one which
+   * wasn't added yet, to the executor of the group set in the `<controller_name>.executor_group`
+   * parameter. Controllers without a group are added to the executor given at construction.
+   * Called once the controller is configured and again once it is started, as lightweight
+   * controllers may create their node in either step.
+   * @warning Should be called with the controllers lock held
+   */
+  void add_controller_to_executor(const ControllerSpec & controller);
+
+  void remove_controller_from_executor(const ControllerSpec & controller);
+
+  std::string get_controller_executor_group(const std::string & controller_name);
+
+  /**
+   * @brief publish_controller_states_snapshot builds a new snapshot from the given list
+   * and makes it available to readers, publishing it on ~/controller_states together with
+   * one event on ~/controller_events per controller whose state changed
+   * @warning Should be called with the controllers lock held
+   */
+  void publish_controller_states_snapshot(const std::vector<ControllerSpec> & controllers);
+
+  void publish_controller_events(
+    const ControllerStatesSnapshot & previous,
+    const ControllerStatesSnapshot & current);
+
+  /// Rebuilds the controller type catalogue from the current loader
+  void refresh_controller_type_catalogue();
+
+  /**
+   * @brief resolve_fallback_controllers fills the fallback indices of every controller
+   * of a list about to be handed to the realtime thread
+   */
+  void resolve_fallback_controllers(std::vector<ControllerSpec> & controllers);
+
+  /**
+   * @brief switch_to_fallback_controllers stops updating a failed controller and selects its
+   * fallbacks, which are waiting in standby. The failed controller is deactivated later by the
+   * non-RT thread, in refresh_controller_states().
+   * @warning Should only be called by the RT thread, with the list it is using
+   */
+  void switch_to_fallback_controllers(
+    std::vector<ControllerSpec> & rt_controller_list,
+    ControllerSpec & failed_controller);
+
+  /**
+   * @brief refresh_controller_states deactivates the controllers which failed in the RT thread
+   * and publishes a new snapshot if the RT thread changed the state of any controller
+   */
+  void refresh_controller_states();
+
+  /**
+   * @brief apply_budget_policy records an update that took longer than the controller budget
+   * and reacts according to the budget policy of the controller
+   * @warning Should only be called by the RT thread, with the list it is using
+   */
+  void apply_budget_policy(
+    std::vector<ControllerSpec> & rt_controller_list,
+    ControllerSpec & controller);
+
+  /// Logs the budget overruns of controllers with BudgetPolicy::WARN, from the non-RT thread
+  void report_budget_overruns();
+
+  /// Current time of the clock used to measure controller updates, in nanoseconds
+  int64_t get_update_clock_ns() const;
+
+  void stop_executor_group(ExecutorGroup & group);
+
+  /// Realtime thread updating the controllers of one group at a fixed period.
+  struct RateGroup
+  {
+    RateGroupConfig config;
+    std::thread thread;
+    std::atomic<bool> running {false};
+    /// Number of updates of the group, used to run demoted controllers at a lower rate
+    uint64_t update_cycle = 0;
+    /// Wall time of the last update, to give controllers the period of the cycle
+    int64_t last_update_ns = 0;
+    /// Simulated time of the last update when stepping, never mixed with the wall time
+    int64_t last_step_ns = 0;
+    /// Simulated time of the next update when stepping
+    int64_t next_step_ns = 0;
+    /// Counters of the thread updating the group, when the perf_counters parameter is set
+    std::unique_ptr<PerfCounters> perf_counters;
+    std::thread::id perf_thread;
+  };
+
+  /// Index of the group named in the `<controller_name>.rate_group` parameter, false if unknown
+  bool get_controller_rate_group(const std::string & controller_name, size_t & rate_group);
+
+  void run_rate_group(size_t rate_group);
+
+  /// Opens the counters of a group for the calling thread, unless it already did it
+  void open_perf_counters(RateGroup & group);
+
+  /**
+   * @brief get_perf_counters returns the counters of a group if the calling thread opened them,
+   * without any system call, so the update of the controllers can use it
+   * @return nullptr if the counters aren't open or count another thread
+   */
+  const PerfCounters * get_perf_counters(const RateGroup & group) const;
+
+  /// Updates the controllers of a group with the time of the cycle
+  controller_interface::return_type update_controllers(
+    size_t rate_group, const rclcpp::Time & time,
+    const rclcpp::Duration & period);
+
+  /// Marks the switch requested by the non-RT thread as done for the given group
+  void finish_switch(size_t rate_group);
+
+  /// Hardware owned by \p rate_group, the manager hardware for the default group
+  hardware_interface::RobotHardware & get_owned_hardware(size_t rate_group) const;
+
   std::shared_ptr<hardware_interface::RobotHardware> hw_;
   std::shared_ptr<rclcpp::Executor> executor_;
   std::shared_ptr<pluginlib::ClassLoader<controller_interface::ControllerInterface>> loader_;
+  /// Only accessed through std::atomic_load and std::atomic_store
+  ControllerTypeCatalogueConstSharedPtr controller_type_catalogue_;
+
+  /// Dedicated executors spun in their own thread, by group name
+  std::unordered_map<std::string, ExecutorGroup> executor_groups_;
+  /// Nodes actually added to an executor, by controller name
+  std::unordered_map<std::string, ControllerNode> controller_nodes_;
+  /// Keeps the manager services apart from the controllers when using a multithreaded executor
+  rclcpp::CallbackGroup::SharedPtr services_callback_group_;
 
   /**
    * @brief The RTControllerListWrapper class wraps a double-buffered list of controllers
@@ -181,13 +436,22 @@ private:
 // *INDENT-OFF*
   public:
 // *INDENT-ON*
+    RTControllerListWrapper();
+
     /**
      * @brief update_and_get_used_by_rt_list Makes the "updated" list the "used by rt" list
      * @warning Should only be called by the RT thread, no one should modify the
      * updated list while it's being used
      * @return reference to the updated list
      */
-    std::vector<ControllerSpec> & update_and_get_used_by_rt_list();
+    std::vector<ControllerSpec> & update_and_get_used_by_rt_list(
+      size_t rate_group = DEFAULT_RATE_GROUP);
+
+    /**
+     * @brief release_rt_list Marks the list as not used by the thread of the given group,
+     * which must not call update_and_get_used_by_rt_list() anymore
+     */
+    void release_rt_list(size_t rate_group);
 
     /**
      * @brief get_unused_list Waits until the "outdated" and "unused by rt"
@@ -232,36 +496,73 @@ private:
 
     std::vector<ControllerSpec> controllers_lists_[2];
     /// The index of the controller list with the most updated information
-    int updated_controllers_index_ = 0;
-    /// The index of the controllers list being used in the real-time thread.
-    int used_by_realtime_controllers_index_ = -1;
+    std::atomic<int> updated_controllers_index_ {0};
+    /// The index of the controllers list being used by the real-time thread of each rate group.
+    std::array<std::atomic<int>, MAX_RATE_GROUPS> used_by_realtime_controllers_indices_;
   };
 
   RTControllerListWrapper rt_controllers_wrapper_;
+  /// Only accessed through std::atomic_load and std::atomic_store
+  ControllerStatesSnapshotConstSharedPtr controller_states_snapshot_;
+  rclcpp::Publisher<controller_manager_msgs::msg::ControllerStates>::SharedPtr
+    controller_states_publisher_;
+  rclcpp::Publisher<controller_manager_msgs::msg::ControllerEvent>::SharedPtr
+    controller_events_publisher_;
+  uint64_t controller_event_sequence_number_ = 0;
+  /// Set by the RT thread when a controller failed, so its lifecycle state is about to change
+  std::atomic<bool> controller_states_changed_ {false};
+  rclcpp::TimerBase::SharedPtr controller_states_refresh_timer_;
+
+  /// Measure updates with CLOCK_THREAD_CPUTIME_ID instead of the steady clock
+  bool use_thread_cpu_clock_ = false;
+  /// Sample perf counters around each controller update
+  bool use_perf_counters_ = false;
+  /// Default group first, never resized while the group threads run
+  std::vector<std::unique_ptr<RateGroup>> rate_groups_;
+  /// One bit per rate group that has not applied the requested switch yet, the switch is done at 0
+  std::atomic<uint32_t> switch_pending_rate_groups_ {0};
+  /// Set by the first step(), every rate group is then updated by step()
+  std::atomic<bool> lockstep_ {false};
+  rclcpp::Time simulated_time_ {0, 0, RCL_ROS_TIME};
+  double step_cycles_per_second_ = 0.0;
   /// mutex copied from ROS1 Control, protects service callbacks
   /// not needed if we're guaranteed that the callbacks don't come from multiple threads
   std::mutex services_lock_;
   rclcpp::Service<controller_manager_msgs::srv::ListControllers>::SharedPtr
     list_controllers_service_;
+  rclcpp::Service<controller_manager_msgs::srv::ListControllerStatistics>::SharedPtr
+    list_controller_statistics_service_;
   rclcpp::Service<controller_manager_msgs::srv::ListControllerTypes>::SharedPtr
     list_controller_types_service_;
   rclcpp::Service<controller_manager_msgs::srv::LoadController>::SharedPtr
     load_controller_service_;
   rclcpp::Service<controller_manager_msgs::srv::ReloadControllerLibraries>::SharedPtr
     reload_controller_libraries_service_;
+  rclcpp::Service<controller_manager_msgs::srv::Step>::SharedPtr
+    step_service_;
+  /// Steps must be able to run while a switch request waits for them, which takes a
+  /// multi-threaded executor
+  rclcpp::CallbackGroup::SharedPtr step_callback_group_;
   rclcpp::Service<controller_manager_msgs::srv::SwitchController>::SharedPtr
     switch_controller_service_;
   rclcpp::Service<controller_manager_msgs::srv::UnloadController>::SharedPtr
     unload_controller_service_;
 
   std::vector<std::string> start_request_, stop_request_;
-#ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
-//  std::list<hardware_interface::ControllerInfo> switch_start_list_, switch_stop_list_;
-#endif
+  /// Fallbacks of the controllers to start, activated in standby
+  std::vector<std::string> standby_request_;
+  /// Controllers really starting and stopping, by rate group,
+  /// handed to the hardware of that group to switch their modes
+  std::array<hardware_interface::ControllerSwitch, MAX_RATE_GROUPS> controller_switches_;
+
+  enum class ModeSwitchState {PENDING, DONE, FAILED};
+  /// Mode switch of the hardware owned by each group, performed by that group
+  std::array<std::atomic<ModeSwitchState>, MAX_RATE_GROUPS> mode_switch_states_;
+  /// One bit per rate group that has not stopped its controllers of the requested switch yet
+  std::atomic<uint32_t> switch_stopping_rate_groups_ {0};
 
   struct SwitchParams
   {
-    bool do_switch = {false};
     bool started = {false};
     rclcpp::Time init_time = {rclcpp::Time::max()};
 
@@ -19,15 +19,35 @@
 #ifndef CONTROLLER_MANAGER__CONTROLLER_SPEC_HPP_
 #define CONTROLLER_MANAGER__CONTROLLER_SPEC_HPP_
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include "controller_interface/controller_interface.hpp"
+#include "controller_manager/controller_statistics.hpp"
+#include "controller_manager/rate_group.hpp"
 #include "hardware_interface/controller_info.hpp"
 
 namespace controller_manager
 {
 
+/** \brief Selection of a controller by the realtime thread updating it
+ *
+ * Fallback controllers are activated in standby along with the controllers they back up, so the
+ * realtime thread switches to them by flipping these flags, without any lifecycle transition.
+ */
+struct ControllerSelection
+{
+  /** Active but not updated until a controller it backs up fails. */
+  std::atomic<bool> standby {false};
+  /**
+   * Set by the realtime thread when the controller failed, it isn't updated, started nor stopped
+   * by that thread anymore. The non-realtime thread then deactivates it and clears the flag.
+   */
+  std::atomic<bool> failed {false};
+};
+
 /** \brief Controller Specification
  *
  * This struct contains both a pointer to a given controller, \ref c, as well
@@ -38,6 +58,15 @@ struct ControllerSpec
 {
   hardware_interface::ControllerInfo info;
   controller_interface::ControllerInterfaceSharedPtr c;
+  /** Position of the \ref info fallback controllers in the list holding this spec. */
+  std::vector<size_t> fallback_indices;
+  ControllerBudget budget;
+  /** Index of the rate group updating this controller. */
+  size_t rate_group = DEFAULT_RATE_GROUP;
+  /** Shared by every copy of this spec, so it survives controller list switches. */
+  std::shared_ptr<ControllerStatistics> statistics;
+  /** Shared by every copy of this spec, like \ref statistics. */
+  std::shared_ptr<ControllerSelection> selection;
 };
 
 }  // namespace controller_manager
@@ -0,0 +1,50 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__CONTROLLER_STATES_SNAPSHOT_HPP_
+#define CONTROLLER_MANAGER__CONTROLLER_STATES_SNAPSHOT_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "controller_manager/controller_spec.hpp"
+#include "controller_manager_msgs/msg/controller_state.hpp"
+
+namespace controller_manager
+{
+
+/** \brief Immutable view of the loaded controllers
+ *
+ * A new snapshot is published by the controller manager every time a controller
+ * is loaded, unloaded or switched. Readers get it without taking any of the
+ * locks used to update the real-time controller lists.
+ * The snapshot holds a reference to each controller, so an old snapshot keeps the
+ * controllers unloaded since then alive for as long as a reader holds it.
+ */
+struct ControllerStatesSnapshot
+{
+  /// Incremented on every published snapshot
+  std::uint64_t version = 0;
+  std::vector<ControllerSpec> controllers;
+  /// State of each controller in \ref controllers, ready to be served
+  std::vector<controller_manager_msgs::msg::ControllerState> states;
+};
+
+using ControllerStatesSnapshotConstSharedPtr = std::shared_ptr<const ControllerStatesSnapshot>;
+/// Controllers of a snapshot, keeping the whole snapshot alive
+using ControllerSpecsConstSharedPtr = std::shared_ptr<const std::vector<ControllerSpec>>;
+
+}  // namespace controller_manager
+#endif  // CONTROLLER_MANAGER__CONTROLLER_STATES_SNAPSHOT_HPP_
@@ -0,0 +1,93 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__CONTROLLER_STATISTICS_HPP_
+#define CONTROLLER_MANAGER__CONTROLLER_STATISTICS_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "controller_manager/perf_counters.hpp"
+
+namespace controller_manager
+{
+
+/** \brief What the controller manager does when a controller exceeds its update budget */
+enum class BudgetPolicy : std::uint8_t
+{
+  /** Only count the overrun. */
+  COUNT = 0,
+  /** Count it and report it from the non-realtime thread. */
+  WARN = 1,
+  /** Halve the update rate of the controller, down to 1/MAX_UPDATE_RATE_DIVIDER. */
+  DEMOTE = 2,
+  /** Stop the controller and start its fallback controllers. */
+  DEACTIVATE = 3,
+};
+
+/** \brief Per-cycle time budget of a controller, read from its parameters at load time */
+struct ControllerBudget
+{
+  static constexpr std::uint32_t MAX_UPDATE_RATE_DIVIDER = 16;
+
+  /** Maximum duration of one update() in nanoseconds, 0 for no budget. */
+  std::int64_t budget_ns = 0;
+  BudgetPolicy policy = BudgetPolicy::COUNT;
+};
+
+/** \brief Update time statistics of a controller
+ *
+ * Written by the realtime thread and read by anyone else, so every member is atomic.
+ */
+struct ControllerStatistics
+{
+  std::atomic<std::uint64_t> update_count {0};
+  std::atomic<std::uint64_t> overrun_count {0};
+  std::atomic<std::int64_t> last_update_ns {0};
+  std::atomic<std::int64_t> max_update_ns {0};
+  std::atomic<std::int64_t> total_update_ns {0};
+  /** The controller is updated once every update_rate_divider cycles. */
+  std::atomic<std::uint32_t> update_rate_divider {1};
+  /** Overruns not yet reported by the non-realtime thread, for BudgetPolicy::WARN. */
+  std::atomic<std::uint64_t> unreported_overruns {0};
+  /** Updates sampled with the perf counters of their thread, see the perf_counters parameter. */
+  std::atomic<std::uint64_t> perf_update_count {0};
+  /** Sum of each PerfCounter over the sampled updates. */
+  std::array<std::atomic<std::uint64_t>, PERF_COUNTER_COUNT> perf_totals {};
+};
+
+/**
+ * \brief Parse a budget policy name: "count", "warn", "demote" or "deactivate"
+ * \return false if the name is not known, \p policy is left untouched
+ */
+inline bool budget_policy_from_string(const std::string & name, BudgetPolicy & policy)
+{
+  if (name == "count") {
+    policy = BudgetPolicy::COUNT;
+  } else if (name == "warn") {
+    policy = BudgetPolicy::WARN;
+  } else if (name == "demote") {
+    policy = BudgetPolicy::DEMOTE;
+  } else if (name == "deactivate") {
+    policy = BudgetPolicy::DEACTIVATE;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace controller_manager
+#endif  // CONTROLLER_MANAGER__CONTROLLER_STATISTICS_HPP_
@@ -0,0 +1,66 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__CONTROLLER_TYPE_CATALOGUE_HPP_
+#define CONTROLLER_MANAGER__CONTROLLER_TYPE_CATALOGUE_HPP_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace controller_manager
+{
+
+/** \brief Information about a controller type declared through pluginlib */
+struct ControllerTypeInfo
+{
+  /** Lookup name of the controller, as used in `<controller_name>.type`. */
+  std::string type;
+
+  /** Base class the controller is exported as. */
+  std::string base_class;
+
+  /** Package declaring the controller. */
+  std::string package;
+
+  /** Path to the library implementing the controller. */
+  std::string library_path;
+
+  /** Description from the plugin manifest. */
+  std::string description;
+};
+
+/** \brief Controller types known to the controller manager
+ *
+ * Built once from the plugin manifests and only rebuilt when the controller
+ * libraries are reloaded, so listing and resolving types doesn't go through
+ * the ament index.
+ */
+struct ControllerTypeCatalogue
+{
+  /** Types in the order pluginlib declared them. */
+  std::vector<ControllerTypeInfo> types;
+
+  /** Index in \ref types of each type, by lookup name. */
+  std::unordered_map<std::string, size_t> index_by_type;
+
+  /** Indices in \ref types of the types declared by each package. */
+  std::unordered_map<std::string, std::vector<size_t>> index_by_package;
+};
+
+using ControllerTypeCatalogueConstSharedPtr = std::shared_ptr<const ControllerTypeCatalogue>;
+
+}  // namespace controller_manager
+#endif  // CONTROLLER_MANAGER__CONTROLLER_TYPE_CATALOGUE_HPP_
@@ -0,0 +1,91 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__PERF_COUNTERS_HPP_
+#define CONTROLLER_MANAGER__PERF_COUNTERS_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "controller_manager/visibility_control.h"
+
+namespace controller_manager
+{
+
+/** \brief Counter sampled around the controller updates */
+enum class PerfCounter : std::uint8_t
+{
+  INSTRUCTIONS = 0,
+  CACHE_MISSES = 1,
+  BRANCH_MISSES = 2,
+  PAGE_FAULTS = 3,
+};
+
+static constexpr size_t PERF_COUNTER_COUNT = 4;
+
+/** Values of all counters, 0 for the ones that aren't available. */
+using PerfSample = std::array<std::uint64_t, PERF_COUNTER_COUNT>;
+
+/** \brief Hardware and software counters of the calling thread, read with perf_event_open
+ *
+ * The counters are opened as a single group, so reading all of them is one read() without any
+ * allocation. Counters that the kernel or the CPU don't provide, e.g. hardware counters in a
+ * virtual machine, are left out and read as 0. Only available on Linux, and only if
+ * kernel.perf_event_paranoid allows measuring user space, which is the default.
+ */
+class PerfCounters
+{
+public:
+  PerfCounters() = default;
+
+  CONTROLLER_MANAGER_PUBLIC
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters & operator=(const PerfCounters &) = delete;
+
+  /**
+   * \brief Open the counters for the calling thread, which is the only one they count
+   * \return false if none of them could be opened, \p error is then set
+   */
+  CONTROLLER_MANAGER_PUBLIC
+  bool open(std::string & error);
+
+  CONTROLLER_MANAGER_PUBLIC
+  void close();
+
+  CONTROLLER_MANAGER_PUBLIC
+  bool is_open() const;
+
+  CONTROLLER_MANAGER_PUBLIC
+  bool has(PerfCounter counter) const;
+
+  /// Current values of the counters since they were opened, false if they can't be read.
+  CONTROLLER_MANAGER_PUBLIC
+  bool read(PerfSample & sample) const;
+
+private:
+  /// File descriptor of the group leader, -1 when closed
+  int group_fd_ = -1;
+  /// File descriptor of each counter, -1 for the ones not available
+  std::array<int, PERF_COUNTER_COUNT> fds_ {{-1, -1, -1, -1}};
+  /// Counters in the order the kernel reports them in the group
+  std::array<PerfCounter, PERF_COUNTER_COUNT> read_order_ {};
+  size_t open_count_ = 0;
+};
+
+}  // namespace controller_manager
+#endif  // CONTROLLER_MANAGER__PERF_COUNTERS_HPP_
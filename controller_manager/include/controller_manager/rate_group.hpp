@@ -0,0 +1,64 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__RATE_GROUP_HPP_
+#define CONTROLLER_MANAGER__RATE_GROUP_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/robot_hardware.hpp"
+
+namespace controller_manager
+{
+
+/** \brief Configuration of a rate group
+ *
+ * A rate group is a realtime thread with its own period, priority and CPU affinity,
+ * updating the controllers assigned to it with the `<controller_name>.rate_group` parameter.
+ * The default group has no thread, it is updated by the caller of ControllerManager::update().
+ */
+struct RateGroupConfig
+{
+  std::string name;
+  std::chrono::nanoseconds period {std::chrono::milliseconds(1)};
+  /** SCHED_FIFO priority of the thread, 0 to keep the default scheduling policy. */
+  int thread_priority = 0;
+  /** CPUs the thread is allowed to run on, empty for no restriction. */
+  std::vector<int> cpu_affinity;
+  /**
+   * Hardware read before and written after each update of the group, required by
+   * ControllerManager::add_rate_group(). The controllers of the group are initialized with it
+   * instead of the manager hardware.
+   * Only the group thread touches it, so it can't be the manager hardware, which belongs to
+   * the loop calling ControllerManager::update().
+   */
+  std::shared_ptr<hardware_interface::RobotHardware> hardware;
+  /**
+   * Start each cycle when wait_for_cycle() of \ref hardware returns instead of every \ref period,
+   * which is only used while the hardware fails to signal cycles.
+   */
+  bool hardware_clocked = false;
+};
+
+/** Index of the group updated by ControllerManager::update(). */
+static constexpr size_t DEFAULT_RATE_GROUP = 0;
+/** Maximum number of rate groups, including the default one. */
+static constexpr size_t MAX_RATE_GROUPS = 8;
+
+}  // namespace controller_manager
+#endif  // CONTROLLER_MANAGER__RATE_GROUP_HPP_
@@ -0,0 +1,101 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONTROLLER_MANAGER__TRIPLE_BUFFER_HPP_
+#define CONTROLLER_MANAGER__TRIPLE_BUFFER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace controller_manager
+{
+
+/** \brief Lock-free single producer, single consumer triple buffer
+ *
+ * Lets controllers of different rate groups exchange data without blocking each other:
+ * the writer always has a buffer to fill and the reader always gets the last complete one.
+ * Neither side allocates, so both may be called from realtime threads.
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+  TripleBuffer()
+  : TripleBuffer(T()) {}
+
+  explicit TripleBuffer(const T & initial_value)
+  : buffers_{{initial_value, initial_value, initial_value}}
+  {}
+
+  TripleBuffer(const TripleBuffer &) = delete;
+  TripleBuffer & operator=(const TripleBuffer &) = delete;
+
+  /// Buffer owned by the writer, filled in place before calling publish()
+  T & write_buffer()
+  {
+    return buffers_[write_index_];
+  }
+
+  /// Makes the write buffer available to the reader, the writer gets a new one
+  void publish()
+  {
+    write_index_ = state_.exchange(
+      static_cast<std::uint8_t>(write_index_ | NEW_DATA), std::memory_order_acq_rel) & INDEX_MASK;
+  }
+
+  void write(const T & value)
+  {
+    write_buffer() = value;
+    publish();
+  }
+
+  /**
+   * \brief Takes the last published buffer, if any
+   * \return true if the read buffer changed since the previous call
+   */
+  bool update()
+  {
+    if (!(state_.load(std::memory_order_acquire) & NEW_DATA)) {
+      return false;
+    }
+    read_index_ = state_.exchange(read_index_, std::memory_order_acq_rel) & INDEX_MASK;
+    return true;
+  }
+
+  /// Buffer owned by the reader, valid until the next call to update()
+  const T & read_buffer() const
+  {
+    return buffers_[read_index_];
+  }
+
+  const T & read()
+  {
+    update();
+    return read_buffer();
+  }
+
+private:
+  static constexpr std::uint8_t INDEX_MASK = 0x3;
+  static constexpr std::uint8_t NEW_DATA = 0x4;
+
+  std::array<T, 3> buffers_;
+  std::uint8_t write_index_ = 0;
+  std::uint8_t read_index_ = 1;
+  /// Index of the buffer in between writer and reader, with NEW_DATA if not read yet
+  std::atomic<std::uint8_t> state_ {2};
+};
+
+}  // namespace controller_manager
+#endif  // CONTROLLER_MANAGER__TRIPLE_BUFFER_HPP_
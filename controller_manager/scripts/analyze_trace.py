@@ -0,0 +1,208 @@
+#!/usr/bin/env python3
+# Copyright 2020 Open Source Robotics Foundation, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Analyze an LTTng trace of the controller manager.
+
+Build with -DCONTROLLER_MANAGER_TRACING=ON, then trace with e.g.:
+
+    lttng create ros2_control
+    lttng enable-event -u 'ros2_control:*'
+    lttng add-context -u -t vpid -t vtid
+    lttng start
+    ...
+    lttng stop
+
+Each phase traced by a *_start and a *_end event becomes a span. The script prints the latency
+distribution of each phase, the longest cycles with the spans they contain, and can write a
+timeline to open in chrome://tracing or https://ui.perfetto.dev.
+"""
+
+import argparse
+import collections
+import json
+import math
+import sys
+
+PROVIDER = 'ros2_control'
+
+# fields telling apart the spans of a same phase
+LABEL_FIELDS = ('controller_name', 'rate_group', 'list_index')
+
+Event = collections.namedtuple('Event', 'time_ns name fields pid tid')
+Span = collections.namedtuple('Span', 'phase label start_ns end_ns pid tid fields')
+
+
+def read_events(trace_path):
+    """Read the ros2_control events of a trace with the babeltrace2 bindings."""
+    try:
+        import bt2
+    except ImportError:
+        sys.exit('reading traces needs the babeltrace2 python bindings (python3-bt2)')
+
+    for message in bt2.TraceCollectionMessageIterator(trace_path):
+        if type(message) is not bt2._EventMessageConst:
+            continue
+        event = message.event
+        if not event.name.startswith(PROVIDER + ':'):
+            continue
+        fields = {name: _to_python(value) for name, value in event.payload_field.items()}
+        context = event.common_context_field or {}
+        yield Event(
+            time_ns=message.default_clock_snapshot.ns_from_origin,
+            name=event.name[len(PROVIDER) + 1:],
+            fields=fields,
+            pid=int(context['vpid']) if 'vpid' in context else 0,
+            tid=int(context['vtid']) if 'vtid' in context else 0)
+
+
+def _to_python(value):
+    if isinstance(value, str) or hasattr(value, 'startswith'):
+        return str(value)
+    return int(value)
+
+
+def label_of(phase, fields):
+    for field in LABEL_FIELDS:
+        if field in fields:
+            value = fields[field]
+            return '%s[%s]' % (phase, value if field != 'rate_group' else 'group %d' % value)
+    return phase
+
+
+def pair_spans(events):
+    """Match the *_start and *_end events of each phase, per thread."""
+    open_spans = collections.defaultdict(list)
+    spans = []
+    for event in events:
+        if event.name.endswith('_start'):
+            phase = event.name[:-len('_start')]
+            label = label_of(phase, event.fields)
+            open_spans[(event.tid, label)].append(event)
+        elif event.name.endswith('_end'):
+            phase = event.name[:-len('_end')]
+            label = label_of(phase, event.fields)
+            starts = open_spans.get((event.tid, label))
+            if not starts:
+                # started before the trace
+                continue
+            start = starts.pop()
+            spans.append(Span(
+                phase=phase, label=label, start_ns=start.time_ns, end_ns=event.time_ns,
+                pid=event.pid, tid=event.tid, fields=event.fields))
+    spans.sort(key=lambda span: span.start_ns)
+    return spans
+
+
+def percentile(sorted_values, fraction):
+    if not sorted_values:
+        return float('nan')
+    index = min(len(sorted_values) - 1, int(math.ceil(fraction * len(sorted_values))) - 1)
+    return sorted_values[max(index, 0)]
+
+
+def latency_table(spans):
+    """Latency distribution of each label, in microseconds."""
+    durations = collections.defaultdict(list)
+    for span in spans:
+        durations[span.label].append((span.end_ns - span.start_ns) / 1e3)
+    rows = []
+    for label in sorted(durations):
+        values = sorted(durations[label])
+        rows.append({
+            'label': label,
+            'count': len(values),
+            'min': values[0],
+            'mean': sum(values) / len(values),
+            'p50': percentile(values, 0.5),
+            'p90': percentile(values, 0.9),
+            'p99': percentile(values, 0.99),
+            'p99.9': percentile(values, 0.999),
+            'max': values[-1],
+        })
+    return rows
+
+
+def print_latency_table(rows, out=sys.stdout):
+    columns = ('count', 'min', 'mean', 'p50', 'p90', 'p99', 'p99.9', 'max')
+    width = max([len('phase')] + [len(row['label']) for row in rows])
+    out.write('%-*s %8s' % (width, 'phase', columns[0]))
+    out.write(''.join(' %9s' % column for column in columns[1:]) + '  (us)\n')
+    for row in rows:
+        out.write('%-*s %8d' % (width, row['label'], row['count']))
+        out.write(''.join(' %9.1f' % row[column] for column in columns[1:]) + '\n')
+
+
+def print_longest_cycles(spans, count, out=sys.stdout):
+    """Print the longest update cycles with the spans of their thread they contain."""
+    cycles = sorted(
+        (span for span in spans if span.phase == 'update'),
+        key=lambda span: span.end_ns - span.start_ns, reverse=True)[:count]
+    for cycle in cycles:
+        out.write('%s at %d ns took %.1f us\n' % (
+            cycle.label, cycle.start_ns, (cycle.end_ns - cycle.start_ns) / 1e3))
+        for span in spans:
+            if span is cycle or span.tid != cycle.tid:
+                continue
+            if cycle.start_ns <= span.start_ns and span.end_ns <= cycle.end_ns:
+                out.write('  +%9.1f us %9.1f us  %s\n' % (
+                    (span.start_ns - cycle.start_ns) / 1e3,
+                    (span.end_ns - span.start_ns) / 1e3, span.label))
+
+
+def chrome_trace(spans):
+    """Spans as complete events of the Chrome trace event format, also read by Perfetto."""
+    return {
+        'displayTimeUnit': 'ns',
+        'traceEvents': [
+            {
+                'name': span.label,
+                'cat': span.phase,
+                'ph': 'X',
+                'ts': span.start_ns / 1e3,
+                'dur': (span.end_ns - span.start_ns) / 1e3,
+                'pid': span.pid,
+                'tid': span.tid,
+                'args': span.fields,
+            }
+            for span in spans
+        ],
+    }
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('trace', help='directory of the LTTng trace')
+    parser.add_argument(
+        '--chrome', metavar='FILE', help='write a timeline in the Chrome trace event format')
+    parser.add_argument(
+        '--longest', metavar='N', type=int, default=5,
+        help='number of longest update cycles to detail (default: %(default)s)')
+    args = parser.parse_args(argv)
+
+    spans = pair_spans(read_events(args.trace))
+    if not spans:
+        sys.exit('no ros2_control spans in ' + args.trace)
+    print_latency_table(latency_table(spans))
+    if args.longest > 0:
+        sys.stdout.write('\n')
+        print_longest_cycles(spans, args.longest)
+    if args.chrome:
+        with open(args.chrome, 'w') as chrome_file:
+            json.dump(chrome_trace(spans), chrome_file)
+
+
+if __name__ == '__main__':
+    main()
@@ -14,9 +14,20 @@
 
 #include "controller_manager/controller_manager.hpp"
 
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
 #include <list>
 #include <memory>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "controller_interface/controller_interface.hpp"
@@ -27,6 +38,8 @@
 
 #include "rclcpp/rclcpp.hpp"
 
+#include "./tracing.hpp"
+
 namespace controller_manager
 {
 
@@ -35,7 +48,7 @@ static constexpr const char * kControllerInterface = "controller_interface::Cont
 
 inline bool is_controller_running(controller_interface::ControllerInterface & controller)
 {
-  return controller.get_lifecycle_node()->get_current_state().id() ==
+  return controller.get_current_state().id() ==
          lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE;
 }
 
@@ -52,6 +65,11 @@ rclcpp::NodeOptions get_cm_node_options()
   return node_options;
 }
 
+static constexpr const char * kLightweightControllersParam = "lightweight_controllers";
+static constexpr const char * kUseStaticExecutorsParam = "use_static_executors";
+static constexpr const char * kBudgetClockParam = "budget_clock";
+static constexpr const char * kPerfCountersParam = "perf_counters";
+
 ControllerManager::ControllerManager(
   std::shared_ptr<hardware_interface::RobotHardware> hw,
   std::shared_ptr<rclcpp::Executor> executor,
@@ -62,33 +80,89 @@ ControllerManager::ControllerManager(
   loader_(std::make_shared<pluginlib::ClassLoader<controller_interface::ControllerInterface>>(
       kControllerInterfaceName, kControllerInterface))
 {
+  declare_parameter(kLightweightControllersParam, false);
+  declare_parameter(kUseStaticExecutorsParam, false);
+  // "steady" or "thread_cpu", the clock used to measure controller updates against budgets
+  declare_parameter(kBudgetClockParam, std::string("steady"));
+  std::string budget_clock;
+  get_parameter(kBudgetClockParam, budget_clock);
+  use_thread_cpu_clock_ = budget_clock == "thread_cpu";
+  // instructions, cache misses, branch misses and page faults of each update, on Linux only,
+  // the thread calling update() opens the counters with init_perf_counters()
+  declare_parameter(kPerfCountersParam, false);
+  get_parameter(kPerfCountersParam, use_perf_counters_);
+
+  for (auto & mode_switch_state : mode_switch_states_) {
+    mode_switch_state = ModeSwitchState::DONE;
+  }
+  // Never reallocated, the group threads index it without locking
+  rate_groups_.reserve(MAX_RATE_GROUPS);
+  rate_groups_.push_back(std::make_unique<RateGroup>());
+
+  refresh_controller_type_catalogue();
+
+  std::atomic_store(
+    &controller_states_snapshot_,
+    ControllerStatesSnapshotConstSharedPtr(std::make_shared<ControllerStatesSnapshot>()));
+  // Latched, so late joiners get the current states without polling ~/list_controllers
+  controller_states_publisher_ = create_publisher<controller_manager_msgs::msg::ControllerStates>(
+    "~/controller_states", rclcpp::QoS(1).transient_local());
+  controller_events_publisher_ = create_publisher<controller_manager_msgs::msg::ControllerEvent>(
+    "~/controller_events", rclcpp::QoS(100));
+  controller_states_publisher_->publish(controller_manager_msgs::msg::ControllerStates());
+  controller_states_refresh_timer_ = create_wall_timer(
+    std::chrono::milliseconds(100), [this]() {
+      refresh_controller_states();
+      report_budget_overruns();
+    });
+
+  services_callback_group_ = create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+
   using namespace std::placeholders;
   list_controllers_service_ = create_service<controller_manager_msgs::srv::ListControllers>(
     "~/list_controllers", std::bind(
       &ControllerManager::list_controllers_srv_cb, this, _1,
-      _2));
+      _2), rmw_qos_profile_services_default, services_callback_group_);
+  list_controller_statistics_service_ =
+    create_service<controller_manager_msgs::srv::ListControllerStatistics>(
+    "~/list_controller_statistics", std::bind(
+      &ControllerManager::list_controller_statistics_srv_cb, this, _1,
+      _2), rmw_qos_profile_services_default, services_callback_group_);
   list_controller_types_service_ =
     create_service<controller_manager_msgs::srv::ListControllerTypes>(
     "~/list_controller_types", std::bind(
       &ControllerManager::list_controller_types_srv_cb, this, _1,
-      _2));
+      _2), rmw_qos_profile_services_default, services_callback_group_);
   load_controller_service_ = create_service<controller_manager_msgs::srv::LoadController>(
     "~/load_controller", std::bind(
       &ControllerManager::load_controller_service_cb, this, _1,
-      _2));
+      _2), rmw_qos_profile_services_default, services_callback_group_);
   reload_controller_libraries_service_ =
     create_service<controller_manager_msgs::srv::ReloadControllerLibraries>(
     "~/reload_controller_libraries", std::bind(
       &ControllerManager::reload_controller_libraries_service_cb, this, _1,
-      _2));
+      _2), rmw_qos_profile_services_default, services_callback_group_);
+  step_callback_group_ = create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+  step_service_ = create_service<controller_manager_msgs::srv::Step>(
+    "~/step", std::bind(
+      &ControllerManager::step_service_cb, this, _1,
+      _2), rmw_qos_profile_services_default, step_callback_group_);
   switch_controller_service_ = create_service<controller_manager_msgs::srv::SwitchController>(
     "~/switch_controller", std::bind(
       &ControllerManager::switch_controller_service_cb, this, _1,
-      _2));
+      _2), rmw_qos_profile_services_default, services_callback_group_);
   unload_controller_service_ = create_service<controller_manager_msgs::srv::UnloadController>(
     "~/unload_controller", std::bind(
       &ControllerManager::unload_controller_service_cb, this, _1,
-      _2));
+      _2), rmw_qos_profile_services_default, services_callback_group_);
+}
+
+ControllerManager::~ControllerManager()
+{
+  stop_rate_groups();
+  for (auto & group : executor_groups_) {
+    stop_executor_group(group.second);
+  }
 }
 
 controller_interface::ControllerInterfaceSharedPtr ControllerManager::load_controller(
@@ -97,7 +171,8 @@ controller_interface::ControllerInterfaceSharedPtr ControllerManager::load_contr
 {
   RCLCPP_INFO(get_logger(), "Loading controller '%s'\n", controller_name.c_str());
 
-  if (!loader_->isClassAvailable(controller_type)) {
+  const auto catalogue = get_controller_type_catalogue();
+  if (catalogue->index_by_type.find(controller_type) == catalogue->index_by_type.end()) {
     const std::string error_msg("Loader for controller '" + controller_name + "' not found\n");
     RCLCPP_ERROR(get_logger(), "%s", error_msg.c_str());
     throw std::runtime_error(error_msg);
@@ -169,13 +244,15 @@ controller_interface::return_type ControllerManager::unload_controller(
   }
 
   RCLCPP_DEBUG(get_logger(), "Cleanup controller");
-  controller.c->get_lifecycle_node()->cleanup();
-  executor_->remove_node(controller.c->get_lifecycle_node()->get_node_base_interface());
+  controller.c->cleanup();
+  remove_controller_from_executor(controller);
   to.erase(found_it);
+  resolve_fallback_controllers(to);
 
   // Destroys the old controllers list when the realtime thread is finished with it.
   RCLCPP_DEBUG(get_logger(), "Realtime switches over to new controller list");
   rt_controllers_wrapper_.switch_updated_list(guard);
+  publish_controller_states_snapshot(to);
   std::vector<ControllerSpec> & new_unused_list = rt_controllers_wrapper_.get_unused_list(
     guard);
   RCLCPP_DEBUG(get_logger(), "Destruct controller");
@@ -186,10 +263,129 @@ controller_interface::return_type ControllerManager::unload_controller(
   return controller_interface::return_type::SUCCESS;
 }
 
-std::vector<ControllerSpec> ControllerManager::get_loaded_controllers() const
+ControllerSpecsConstSharedPtr ControllerManager::get_loaded_controllers() const
 {
-  std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
-  return rt_controllers_wrapper_.get_updated_list(guard);
+  const auto snapshot = get_controller_states_snapshot();
+  return ControllerSpecsConstSharedPtr(snapshot, &snapshot->controllers);
+}
+
+ControllerStatesSnapshotConstSharedPtr ControllerManager::get_controller_states_snapshot() const
+{
+  return std::atomic_load(&controller_states_snapshot_);
+}
+
+ControllerTypeCatalogueConstSharedPtr ControllerManager::get_controller_type_catalogue() const
+{
+  return std::atomic_load(&controller_type_catalogue_);
+}
+
+void ControllerManager::refresh_controller_type_catalogue()
+{
+  auto catalogue = std::make_shared<ControllerTypeCatalogue>();
+  const auto declared_types = loader_->getDeclaredClasses();
+  catalogue->types.reserve(declared_types.size());
+  for (const auto & declared_type : declared_types) {
+    ControllerTypeInfo info;
+    info.type = declared_type;
+    info.base_class = loader_->getBaseClassType();
+    info.package = loader_->getClassPackage(declared_type);
+    info.description = loader_->getClassDescription(declared_type);
+    try {
+      info.library_path = loader_->getClassLibraryPath(declared_type);
+    } catch (const pluginlib::LibraryLoadException & e) {
+      // Still listed, loading it will fail with a proper error
+      RCLCPP_WARN(
+        get_logger(), "No library found for controller type '%s': %s",
+        declared_type.c_str(), e.what());
+    }
+
+    const size_t index = catalogue->types.size();
+    catalogue->index_by_type[info.type] = index;
+    catalogue->index_by_package[info.package].push_back(index);
+    catalogue->types.push_back(std::move(info));
+  }
+  RCLCPP_DEBUG(
+    get_logger(), "Controller type catalogue has %zu types", catalogue->types.size());
+  std::atomic_store(
+    &controller_type_catalogue_, ControllerTypeCatalogueConstSharedPtr(std::move(catalogue)));
+}
+
+void ControllerManager::publish_controller_states_snapshot(
+  const std::vector<ControllerSpec> & controllers)
+{
+  auto snapshot = std::make_shared<ControllerStatesSnapshot>();
+  snapshot->version = get_controller_states_snapshot()->version + 1;
+  snapshot->controllers = controllers;
+  snapshot->states.resize(controllers.size());
+  for (size_t i = 0; i < controllers.size(); ++i) {
+    controller_manager_msgs::msg::ControllerState & cs = snapshot->states[i];
+    cs.name = controllers[i].info.name;
+    cs.type = controllers[i].info.type;
+    // standby fallbacks are active, but not updated yet
+    cs.state = controllers[i].selection->standby ?
+      "standby" : controllers[i].c->get_current_state().label();
+  }
+  const auto previous_snapshot = std::atomic_exchange(
+    &controller_states_snapshot_, ControllerStatesSnapshotConstSharedPtr(snapshot));
+
+  controller_manager_msgs::msg::ControllerStates states_msg;
+  states_msg.version = snapshot->version;
+  states_msg.controller = snapshot->states;
+  controller_states_publisher_->publish(states_msg);
+  publish_controller_events(*previous_snapshot, *snapshot);
+}
+
+void ControllerManager::publish_controller_events(
+  const ControllerStatesSnapshot & previous,
+  const ControllerStatesSnapshot & current)
+{
+  using controller_manager_msgs::msg::ControllerEvent;
+
+  const auto stamp = now();
+  const auto publish_event =
+    [&](const controller_manager_msgs::msg::ControllerState & state, uint8_t transition)
+    {
+      ControllerEvent event;
+      event.stamp = stamp;
+      event.sequence_number = ++controller_event_sequence_number_;
+      event.version = current.version;
+      event.name = state.name;
+      event.type = state.type;
+      event.transition = transition;
+      controller_events_publisher_->publish(event);
+    };
+
+  std::unordered_map<std::string, const controller_manager_msgs::msg::ControllerState *>
+  previous_states;
+  for (const auto & state : previous.states) {
+    previous_states[state.name] = &state;
+  }
+
+  for (const auto & state : current.states) {
+    const auto previous_it = previous_states.find(state.name);
+    const std::string previous_label =
+      previous_it == previous_states.end() ? "" : previous_it->second->state;
+    if (previous_it == previous_states.end()) {
+      publish_event(state, ControllerEvent::LOADED);
+    } else {
+      previous_states.erase(previous_it);
+    }
+    if (state.state == previous_label) {
+      continue;
+    }
+    if (state.state == "active") {
+      publish_event(state, ControllerEvent::ACTIVE);
+    } else if (state.state == "inactive") {
+      // standby fallbacks were active too
+      const bool was_active = previous_label == "active" || previous_label == "standby";
+      publish_event(state, was_active ? ControllerEvent::INACTIVE : ControllerEvent::CONFIGURED);
+    }
+  }
+
+  // Whatever is left was not found in the current snapshot
+  for (const auto & previous_state : previous_states) {
+    publish_event(*previous_state.second, ControllerEvent::UNLOADED);
+  }
 }
 
 controller_interface::return_type ControllerManager::switch_controller(
@@ -199,6 +395,9 @@ controller_interface::return_type ControllerManager::switch_controller(
   bool start_asap,
   const rclcpp::Duration & timeout)
 {
+  CONTROLLER_MANAGER_TRACE_SCOPE(
+    switch_controller_start, switch_controller_end, start_controllers.size(),
+    stop_controllers.size());
   switch_params_ = SwitchParams();
 
   if (!stop_request_.empty() || !start_request_.empty()) {
@@ -289,9 +488,10 @@ controller_interface::return_type ControllerManager::switch_controller(
 #ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
   // Do the resource management checking
   std::list<hardware_interface::ControllerInfo> info_list;
-  switch_start_list_.clear();
-  switch_stop_list_.clear();
 #endif
+  for (auto & controller_switch : controller_switches_) {
+    controller_switch = hardware_interface::ControllerSwitch();
+  }
 
   // lock controllers
   std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
@@ -308,7 +508,9 @@ controller_interface::return_type ControllerManager::switch_controller(
       start_request_.begin(), start_request_.end(), controller.info.name);
     bool in_start_list = start_list_it != start_request_.end();
 
-    const bool is_running = is_controller_running(*controller.c);
+    // starting a standby fallback only selects it
+    const bool is_running = is_controller_running(*controller.c) &&
+      !(controller.selection->standby && in_start_list);
 
     auto handle_conflict = [&](const std::string & msg)
       {
@@ -348,13 +550,15 @@ controller_interface::return_type ControllerManager::switch_controller(
       start_request_.erase(start_list_it);
     }
 
-#ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
     if (is_running && in_stop_list && !in_start_list) {  // running and real stop
-      switch_stop_list_.push_back(info);
+      controller_switches_[controller.rate_group].stop_controllers.push_back(
+        controller.info);
     } else if (!is_running && !in_stop_list && in_start_list) {  // start, but no restart
-      switch_start_list_.push_back(info);
+      controller_switches_[controller.rate_group].start_controllers.push_back(
+        controller.info);
     }
 
+#ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
     bool add_to_list = is_running;
     if (in_stop_list) {
       add_to_list = false;
@@ -369,6 +573,83 @@ controller_interface::return_type ControllerManager::switch_controller(
 #endif
   }
 
+  // fallbacks are activated in standby with the controllers they back up, and stopped with them
+  const auto is_requested = [](const std::vector<std::string> & request, const std::string & name)
+    {
+      return std::find(request.begin(), request.end(), name) != request.end();
+    };
+  const auto find_controller = [&controllers](const std::string & name)
+    {
+      return std::find_if(
+        controllers.begin(), controllers.end(),
+        std::bind(controller_name_compare, std::placeholders::_1, name));
+    };
+  standby_request_.clear();
+  for (const auto & controller : controllers) {
+    if (!is_requested(start_request_, controller.info.name)) {
+      continue;
+    }
+    for (const auto & fallback_name : controller.info.fallback_controllers) {
+      const auto fallback_it = find_controller(fallback_name);
+      if (fallback_it == controllers.end() || fallback_it->rate_group != controller.rate_group ||
+        is_controller_running(*fallback_it->c) || is_requested(start_request_, fallback_name) ||
+        is_requested(standby_request_, fallback_name))
+      {
+        continue;
+      }
+      standby_request_.push_back(fallback_name);
+    }
+  }
+  const auto keeps_running = [&](const ControllerSpec & controller)
+    {
+      return is_requested(start_request_, controller.info.name) ||
+             (is_controller_running(*controller.c) && !controller.selection->standby &&
+             !is_requested(stop_request_, controller.info.name));
+    };
+  for (const auto & controller : controllers) {
+    if (!is_requested(stop_request_, controller.info.name) || keeps_running(controller)) {
+      continue;
+    }
+    for (const auto & fallback_name : controller.info.fallback_controllers) {
+      const auto fallback_it = find_controller(fallback_name);
+      if (fallback_it == controllers.end() || !fallback_it->selection->standby ||
+        is_requested(start_request_, fallback_name) || is_requested(stop_request_, fallback_name))
+      {
+        continue;
+      }
+      // still backing up another controller
+      if (std::any_of(
+          controllers.begin(), controllers.end(), [&](const ControllerSpec & other) {
+            return keeps_running(other) &&
+            is_requested(other.info.fallback_controllers, fallback_name);
+          }))
+      {
+        continue;
+      }
+      stop_request_.push_back(fallback_name);
+    }
+  }
+
+  // only the default group is updated by the caller, the others apply the switch in their thread
+  if (!lockstep_) {
+    for (const auto & controller : controllers) {
+      if (controller.rate_group == DEFAULT_RATE_GROUP ||
+        rate_groups_[controller.rate_group]->running ||
+        (!is_requested(start_request_, controller.info.name) &&
+        !is_requested(stop_request_, controller.info.name)))
+      {
+        continue;
+      }
+      RCLCPP_ERROR(
+        get_logger(), "Could not switch controller '%s', its rate group '%s' is not running",
+        controller.info.name.c_str(), rate_groups_[controller.rate_group]->config.name.c_str());
+      stop_request_.clear();
+      start_request_.clear();
+      standby_request_.clear();
+      return controller_interface::return_type::ERROR;
+    }
+  }
+
 #ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
   bool in_conflict = robot_hw_->checkForConflict(info_list);
   if (in_conflict) {
@@ -377,17 +658,31 @@ controller_interface::return_type ControllerManager::switch_controller(
     start_request_.clear();
     return controller_interface::return_type::ERROR;
   }
+#endif
 
-  if (!robot_hw_->prepareSwitch(switch_start_list_, switch_stop_list_)) {
-    RCLCPP_ERROR(
-      get_logger(),
-      "Could not switch controllers. The hardware interface combination "
-      "for the requested controllers is unfeasible.");
-    stop_request_.clear();
-    start_request_.clear();
-    return controller_interface::return_type::ERROR;
+  // each hardware only hears about the controllers claiming its interfaces
+  const auto is_empty = [](const hardware_interface::ControllerSwitch & controller_switch)
+    {
+      return controller_switch.start_controllers.empty() &&
+             controller_switch.stop_controllers.empty();
+    };
+  for (size_t i = 0; i < rate_groups_.size(); ++i) {
+    if (is_empty(controller_switches_[i])) {
+      continue;
+    }
+    if (get_owned_hardware(i).prepare_mode_switch(controller_switches_[i]) !=
+      hardware_interface::return_type::OK)
+    {
+      RCLCPP_ERROR(
+        get_logger(),
+        "Could not switch controllers. The hardware interface combination "
+        "for the requested controllers is unfeasible.");
+      stop_request_.clear();
+      start_request_.clear();
+      standby_request_.clear();
+      return controller_interface::return_type::ERROR;
+    }
   }
-#endif
 
   if (start_request_.empty() && stop_request_.empty()) {
     RCLCPP_INFO(get_logger(), "Empty start and stop list, not requesting switch");
@@ -399,27 +694,189 @@ controller_interface::return_type ControllerManager::switch_controller(
   switch_params_.start_asap = start_asap;
   switch_params_.init_time = rclcpp::Clock().now();
   switch_params_.timeout = timeout;
-  switch_params_.do_switch = true;
+  // every running group applies the switch to its own controllers
+  uint32_t pending_rate_groups = 1u << DEFAULT_RATE_GROUP;
+  for (size_t i = DEFAULT_RATE_GROUP + 1; i < rate_groups_.size(); ++i) {
+    if (rate_groups_[i]->running || lockstep_) {
+      pending_rate_groups |= 1u << i;
+    }
+  }
+  for (size_t i = 0; i < mode_switch_states_.size(); ++i) {
+    mode_switch_states_[i] =
+      is_empty(controller_switches_[i]) ? ModeSwitchState::DONE : ModeSwitchState::PENDING;
+  }
+  switch_stopping_rate_groups_ = pending_rate_groups;
+  // published last, the groups see the switch parameters once they see their bit
+  switch_pending_rate_groups_ = pending_rate_groups;
 
   // wait until switch is finished
   RCLCPP_DEBUG(get_logger(), "Request atomic controller switch from realtime loop");
-  while (rclcpp::ok() && switch_params_.do_switch) {
+  const auto wait_start = std::chrono::steady_clock::now();
+  bool warned = false;
+  while (rclcpp::ok() && switch_pending_rate_groups_ != 0) {
+    if (lockstep_ && !warned &&
+      std::chrono::steady_clock::now() - wait_start > std::chrono::seconds(1))
+    {
+      // a single-threaded executor can't serve the steps while this request waits
+      RCLCPP_WARN(
+        get_logger(), "Still waiting for a step to switch controllers, steps are only served "
+        "meanwhile by a multi-threaded executor");
+      warned = true;
+    }
     if (!rclcpp::ok()) {
       return controller_interface::return_type::ERROR;
     }
     std::this_thread::sleep_for(std::chrono::microseconds(100));
   }
+
+  {
+    std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+    const auto & updated_controllers = rt_controllers_wrapper_.get_updated_list(guard);
+    // lightweight controllers may have created their node while starting
+    for (const auto & controller : updated_controllers) {
+      if (std::find(start_request_.begin(), start_request_.end(), controller.info.name) !=
+        start_request_.end())
+      {
+        add_controller_to_executor(controller);
+      }
+    }
+    publish_controller_states_snapshot(updated_controllers);
+  }
   start_request_.clear();
   stop_request_.clear();
+  standby_request_.clear();
 
+  if (std::any_of(
+      mode_switch_states_.begin(), mode_switch_states_.end(),
+      [](const std::atomic<ModeSwitchState> & state) {return state == ModeSwitchState::FAILED;}))
+  {
+    RCLCPP_ERROR(
+      get_logger(), "The hardware failed to switch modes, controllers were not started");
+    return controller_interface::return_type::ERROR;
+  }
   RCLCPP_DEBUG(get_logger(), "Successfully switched controllers");
   return controller_interface::return_type::SUCCESS;
 }
 
+controller_interface::return_type ControllerManager::reload_controller_libraries(
+  const std::vector<std::string> & controller_types,
+  bool force_kill)
+{
+  // find the controllers using the libraries to reload
+  std::vector<hardware_interface::ControllerInfo> affected_controllers;
+  std::vector<std::string> affected_names, running_controllers;
+  {
+    // lock controllers
+    std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+    for (const auto & controller : rt_controllers_wrapper_.get_updated_list(guard)) {
+      if (std::find(
+          controller_types.begin(), controller_types.end(),
+          controller.info.type) == controller_types.end())
+      {
+        continue;
+      }
+      affected_controllers.push_back(controller.info);
+      affected_names.push_back(controller.info.name);
+      if (is_controller_running(*controller.c)) {
+        running_controllers.push_back(controller.info.name);
+      }
+    }
+  }
+  if (!running_controllers.empty() && !force_kill) {
+    RCLCPP_ERROR(
+      get_logger(), "Controller manager: Cannot reload controller libraries because"
+      " there are still %i controllers of these types running",
+      (int)running_controllers.size());
+    return controller_interface::return_type::ERROR;
+  }
+
+  // stop and unload the affected controllers only
+  if (!running_controllers.empty() &&
+    switch_controller(
+      {}, running_controllers,
+      controller_manager_msgs::srv::SwitchController::Request::BEST_EFFORT) !=
+    controller_interface::return_type::SUCCESS)
+  {
+    RCLCPP_ERROR(
+      get_logger(),
+      "Controller manager: Cannot reload controller libraries because failed to stop "
+      "running controllers");
+    return controller_interface::return_type::ERROR;
+  }
+  for (const auto & controller_name : affected_names) {
+    if (unload_controller(controller_name) != controller_interface::return_type::SUCCESS) {
+      RCLCPP_ERROR(
+        get_logger(), "Controller manager: Cannot reload controller libraries because "
+        "failed to unload controller '%s'",
+        controller_name.c_str());
+      return controller_interface::return_type::ERROR;
+    }
+  }
+
+  // close and reopen the libraries, other libraries stay loaded
+  for (const auto & controller_type : controller_types) {
+    try {
+      if (loader_->isClassLoaded(controller_type) &&
+        loader_->unloadLibraryForClass(controller_type) > 0)
+      {
+        RCLCPP_WARN(
+          get_logger(), "Library for '%s' is still in use and was not closed",
+          controller_type.c_str());
+      }
+    } catch (const pluginlib::PluginlibException & e) {
+      RCLCPP_WARN(
+        get_logger(), "Could not unload library for '%s': %s",
+        controller_type.c_str(), e.what());
+    }
+  }
+  loader_->refreshDeclaredClasses();
+  refresh_controller_type_catalogue();
+  for (const auto & controller_type : controller_types) {
+    try {
+      loader_->loadLibraryForClass(controller_type);
+    } catch (const pluginlib::PluginlibException & e) {
+      RCLCPP_ERROR(
+        get_logger(), "Could not load library for '%s': %s",
+        controller_type.c_str(), e.what());
+      return controller_interface::return_type::ERROR;
+    }
+  }
+
+  // bring the controllers back as they were
+  for (const auto & controller : affected_controllers) {
+    try {
+      if (!load_controller(controller.name, controller.type)) {
+        return controller_interface::return_type::ERROR;
+      }
+    } catch (const std::exception & e) {
+      RCLCPP_ERROR(
+        get_logger(), "Could not load controller '%s' again: %s",
+        controller.name.c_str(), e.what());
+      return controller_interface::return_type::ERROR;
+    }
+  }
+  if (!running_controllers.empty() &&
+    switch_controller(
+      running_controllers, {},
+      controller_manager_msgs::srv::SwitchController::Request::BEST_EFFORT) !=
+    controller_interface::return_type::SUCCESS)
+  {
+    RCLCPP_ERROR(get_logger(), "Could not restart controllers after reloading their libraries");
+    return controller_interface::return_type::ERROR;
+  }
+
+  RCLCPP_INFO(
+    get_logger(), "Controller manager: reloaded libraries of %zu controller types",
+    controller_types.size());
+  return controller_interface::return_type::SUCCESS;
+}
+
 controller_interface::ControllerInterfaceSharedPtr
 ControllerManager::add_controller_impl(
   const ControllerSpec & controller)
 {
+  CONTROLLER_MANAGER_TRACE_SCOPE(
+    add_controller_start, add_controller_end, controller.info.name.c_str());
   // lock controllers
   std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
 
@@ -442,19 +899,75 @@ ControllerManager::add_controller_impl(
     return nullptr;
   }
 
-  controller.c->init(hw_, controller.info.name);
+  size_t rate_group = DEFAULT_RATE_GROUP;
+  if (!get_controller_rate_group(controller.info.name, rate_group)) {
+    to.clear();
+    RCLCPP_ERROR(
+      get_logger(), "Controller '%s' is assigned to an unknown rate group",
+      controller.info.name.c_str());
+    return nullptr;
+  }
+
+  // the controllers of a group only get the interfaces of the hardware it owns
+  const auto & hardware =
+    rate_group == DEFAULT_RATE_GROUP ? hw_ : rate_groups_[rate_group]->config.hardware;
+  bool lightweight = false;
+  get_parameter(kLightweightControllersParam, lightweight);
+  if (lightweight) {
+    // Controller shares this node for parameters, no dedicated node unless it asks for one
+    controller.c->init(hardware, controller.info.name, get_node_parameters_interface());
+  } else {
+    controller.c->init(hardware, controller.info.name);
+  }
 
   // TODO(v-lopez) this should only be done if controller_manager is configured.
   // Probably the whole load_controller part should fail if the controller_manager
   // is not configured, should it implement a LifecycleNodeInterface
   // https://github.com/ros-controls/ros2_control/issues/152
-  controller.c->get_lifecycle_node()->configure();
-  executor_->add_node(controller.c->get_lifecycle_node()->get_node_base_interface());
+  controller.c->configure();
+  add_controller_to_executor(controller);
   to.emplace_back(controller);
+  to.back().rate_group = rate_group;
+
+  const std::string fallback_param = controller.info.name + ".fallback_controllers";
+  if (!has_parameter(fallback_param)) {
+    declare_parameter(fallback_param, rclcpp::ParameterValue(std::vector<std::string>()));
+  }
+  get_parameter(fallback_param, to.back().info.fallback_controllers);
+  resolve_fallback_controllers(to);
+
+  const std::string claimed_interfaces_param = controller.info.name + ".claimed_interfaces";
+  if (!has_parameter(claimed_interfaces_param)) {
+    declare_parameter(
+      claimed_interfaces_param, rclcpp::ParameterValue(std::vector<std::string>()));
+  }
+  get_parameter(claimed_interfaces_param, to.back().info.claimed_interfaces);
+
+  const std::string budget_param = controller.info.name + ".update_budget_us";
+  const std::string policy_param = controller.info.name + ".budget_policy";
+  if (!has_parameter(budget_param)) {
+    declare_parameter(budget_param, 0.0);
+  }
+  if (!has_parameter(policy_param)) {
+    declare_parameter(policy_param, std::string("count"));
+  }
+  double budget_us = 0.0;
+  std::string policy;
+  get_parameter(budget_param, budget_us);
+  get_parameter(policy_param, policy);
+  to.back().budget.budget_ns = static_cast<int64_t>(budget_us * 1e3);
+  if (!budget_policy_from_string(policy, to.back().budget.policy)) {
+    RCLCPP_WARN(
+      get_logger(), "Unknown budget policy '%s' for controller '%s', only counting overruns",
+      policy.c_str(), controller.info.name.c_str());
+  }
+  to.back().statistics = std::make_shared<ControllerStatistics>();
+  to.back().selection = std::make_shared<ControllerSelection>();
 
   // Destroys the old controllers list when the realtime thread is finished with it.
   RCLCPP_DEBUG(get_logger(), "Realtime switches over to new controller list");
   rt_controllers_wrapper_.switch_updated_list(guard);
+  publish_controller_states_snapshot(to);
   RCLCPP_DEBUG(get_logger(), "Destruct controller");
   std::vector<ControllerSpec> & new_unused_list = rt_controllers_wrapper_.get_unused_list(
     guard);
@@ -464,31 +977,167 @@ ControllerManager::add_controller_impl(
   return to.back().c;
 }
 
-void ControllerManager::manage_switch()
+void ControllerManager::resolve_fallback_controllers(std::vector<ControllerSpec> & controllers)
 {
-#ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
-  // switch hardware interfaces (if any)
-  if (!switch_params_.started) {
-    robot_hw_->doSwitch(switch_start_list_, switch_stop_list_);
-    switch_params_.started = true;
+  for (auto & controller : controllers) {
+    controller.fallback_indices.clear();
+    for (const auto & fallback : controller.info.fallback_controllers) {
+      auto found_it = std::find_if(
+        controllers.begin(), controllers.end(),
+        std::bind(controller_name_compare, std::placeholders::_1, fallback));
+      if (found_it == controllers.end()) {
+        RCLCPP_DEBUG(
+          get_logger(), "Fallback controller '%s' of '%s' is not loaded",
+          fallback.c_str(), controller.info.name.c_str());
+        continue;
+      }
+      if (found_it->rate_group != controller.rate_group) {
+        RCLCPP_WARN(
+          get_logger(), "Fallback controller '%s' of '%s' is in another rate group, ignoring it",
+          fallback.c_str(), controller.info.name.c_str());
+        continue;
+      }
+      controller.fallback_indices.push_back(
+        static_cast<size_t>(std::distance(controllers.begin(), found_it)));
+    }
+  }
+}
+
+void ControllerManager::switch_to_fallback_controllers(
+  std::vector<ControllerSpec> & rt_controller_list,
+  ControllerSpec & failed_controller)
+{
+  // no lifecycle transition nor logging here, refresh_controller_states() takes care of them
+  failed_controller.selection->failed = true;
+  for (const auto index : failed_controller.fallback_indices) {
+    rt_controller_list[index].selection->standby = false;
+  }
+  controller_states_changed_ = true;
+}
+
+void ControllerManager::refresh_controller_states()
+{
+  if (!controller_states_changed_.exchange(false)) {
+    return;
+  }
+  std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
+  const auto & controllers = rt_controllers_wrapper_.get_updated_list(guard);
+  for (const auto & controller : controllers) {
+    if (!controller.selection->failed) {
+      continue;
+    }
+    std::string fallbacks;
+    for (const auto index : controller.fallback_indices) {
+      const auto & fallback = controllers[index];
+      if (!is_controller_running(*fallback.c)) {
+        // loaded after the controller was started, so it wasn't waiting in standby
+        RCLCPP_WARN(
+          get_logger(), "Fallback controller '%s' of '%s' isn't active, it can't take over",
+          fallback.info.name.c_str(), controller.info.name.c_str());
+        continue;
+      }
+      fallbacks += (fallbacks.empty() ? "'" : ", '") + fallback.info.name + "'";
+    }
+    RCLCPP_ERROR(
+      get_logger(), "Controller '%s' failed, deactivating it%s%s", controller.info.name.c_str(),
+      fallbacks.empty() ? "" : ", switched to ", fallbacks.c_str());
+    // the RT thread doesn't touch the controller until the flag is cleared
+    controller.c->deactivate();
+    controller.selection->failed = false;
+  }
+  publish_controller_states_snapshot(controllers);
+}
+
+int64_t ControllerManager::get_update_clock_ns() const
+{
+#ifndef _WIN32
+  if (use_thread_cpu_clock_) {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
   }
 #endif
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-  stop_controllers();
+void ControllerManager::apply_budget_policy(
+  std::vector<ControllerSpec> & rt_controller_list,
+  ControllerSpec & controller)
+{
+  auto & statistics = *controller.statistics;
+  ++statistics.overrun_count;
+  switch (controller.budget.policy) {
+    case BudgetPolicy::COUNT:
+      break;
+    case BudgetPolicy::WARN:
+      // logged by the non-RT thread
+      ++statistics.unreported_overruns;
+      break;
+    case BudgetPolicy::DEMOTE:
+      // served from the statistics, the lifecycle state and so the snapshot don't change
+      if (statistics.update_rate_divider < ControllerBudget::MAX_UPDATE_RATE_DIVIDER) {
+        statistics.update_rate_divider = statistics.update_rate_divider * 2;
+      }
+      break;
+    case BudgetPolicy::DEACTIVATE:
+      switch_to_fallback_controllers(rt_controller_list, controller);
+      break;
+  }
+}
+
+void ControllerManager::report_budget_overruns()
+{
+  const auto snapshot = get_controller_states_snapshot();
+  for (const auto & controller : snapshot->controllers) {
+    const auto overruns = controller.statistics->unreported_overruns.exchange(0);
+    if (overruns > 0) {
+      RCLCPP_WARN(
+        get_logger(), "Controller '%s' exceeded its %.1f us budget %llu times, last update %.1f us",
+        controller.info.name.c_str(), controller.budget.budget_ns / 1e3,
+        static_cast<unsigned long long>(overruns), controller.statistics->last_update_ns / 1e3);
+    }
+  }
+}
+
+void ControllerManager::manage_switch(size_t rate_group)
+{
+  CONTROLLER_MANAGER_TRACE_SCOPE(manage_switch_start, manage_switch_end, rate_group);
+  const uint32_t bit = 1u << rate_group;
+  if (switch_stopping_rate_groups_ & bit) {
+    stop_controllers(rate_group);
+    switch_stopping_rate_groups_.fetch_and(~bit);
+  }
+
+  // each group owns its hardware, so it switches the modes of all its interfaces at once right
+  // after stopping its controllers
+  if (mode_switch_states_[rate_group] == ModeSwitchState::PENDING) {
+    const bool switched = get_owned_hardware(rate_group).perform_mode_switch(
+      controller_switches_[rate_group]) == hardware_interface::return_type::OK;
+    // reported by switch_controller(), not from the realtime loop
+    mode_switch_states_[rate_group] = switched ? ModeSwitchState::DONE : ModeSwitchState::FAILED;
+  }
+
+  // controllers don't start before the hardware they claim switched modes
+  if (mode_switch_states_[rate_group] == ModeSwitchState::FAILED) {
+    // controllers to start would command interfaces in the wrong mode
+    finish_switch(rate_group);
+    return;
+  }
 
   // start controllers once the switch is fully complete
   if (!switch_params_.start_asap) {
-    start_controllers();
+    start_controllers(rate_group);
   } else {
     // start controllers as soon as their required joints are done switching
-    start_controllers_asap();
+    start_controllers_asap(rate_group);
   }
 }
 
-void ControllerManager::stop_controllers()
+void ControllerManager::stop_controllers(size_t rate_group)
 {
   std::vector<ControllerSpec> & rt_controller_list =
-    rt_controllers_wrapper_.update_and_get_used_by_rt_list();
+    rt_controllers_wrapper_.update_and_get_used_by_rt_list(rate_group);
   // stop controllers
   for (const auto & request : stop_request_) {
     auto found_it = std::find_if(
@@ -501,9 +1150,14 @@ void ControllerManager::stop_controllers()
         request.c_str());
       continue;
     }
+    // failed controllers are deactivated by the non-RT thread
+    if (found_it->rate_group != rate_group || found_it->selection->failed) {
+      continue;
+    }
     auto controller = found_it->c;
+    found_it->selection->standby = false;
     if (is_controller_running(*controller)) {
-      const auto new_state = controller->get_lifecycle_node()->deactivate();
+      const auto & new_state = controller->deactivate();
       if (new_state.id() != lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE) {
         RCLCPP_ERROR(
           get_logger(),
@@ -515,7 +1169,7 @@ void ControllerManager::stop_controllers()
   }
 }
 
-void ControllerManager::start_controllers()
+void ControllerManager::start_controllers(size_t rate_group)
 {
 #ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
   // start controllers
@@ -545,7 +1199,7 @@ void ControllerManager::start_controllers()
 #else
   //  Dummy implementation, replace with the code above when migrated
   std::vector<ControllerSpec> & rt_controller_list =
-    rt_controllers_wrapper_.update_and_get_used_by_rt_list();
+    rt_controllers_wrapper_.update_and_get_used_by_rt_list(rate_group);
   for (const auto & request : start_request_) {
     auto found_it = std::find_if(
       rt_controller_list.begin(), rt_controller_list.end(),
@@ -557,22 +1211,45 @@ void ControllerManager::start_controllers()
         request.c_str());
       continue;
     }
+    if (found_it->rate_group != rate_group || found_it->selection->failed) {
+      continue;
+    }
+    if (found_it->selection->standby) {
+      // already active, only selected now
+      found_it->selection->standby = false;
+      continue;
+    }
     auto controller = found_it->c;
-    const auto new_state = controller->get_lifecycle_node()->activate();
+    const auto & new_state = controller->activate();
     if (new_state.id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE) {
       RCLCPP_ERROR(
         get_logger(),
         "After activating, controller %s is in state %s, expected Active",
-        controller->get_lifecycle_node()->get_name(),
+        request.c_str(),
         new_state.label().c_str());
     }
   }
-  // All controllers started, switching done
-  switch_params_.do_switch = false;
+  for (const auto & request : standby_request_) {
+    auto found_it = std::find_if(
+      rt_controller_list.begin(), rt_controller_list.end(),
+      std::bind(controller_name_compare, std::placeholders::_1, request));
+    if (found_it == rt_controller_list.end() || found_it->rate_group != rate_group) {
+      continue;
+    }
+    // not updated until the controller it backs up fails
+    found_it->selection->standby = true;
+    if (found_it->c->activate().id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE) {
+      found_it->selection->standby = false;
+      RCLCPP_ERROR(
+        get_logger(), "Could not activate fallback controller %s in standby", request.c_str());
+    }
+  }
+  // All controllers of this group started, switching done once every group is
+  finish_switch(rate_group);
 #endif
 }
 
-void ControllerManager::start_controllers_asap()
+void ControllerManager::start_controllers_asap(size_t rate_group)
 {
 #ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
   // start controllers if possible
@@ -614,7 +1291,7 @@ void ControllerManager::start_controllers_asap()
   }
 #else
   //  Dummy implementation, replace with the code above when migrated
-  start_controllers();
+  start_controllers(rate_group);
 #endif
 }
 
@@ -622,24 +1299,15 @@ void ControllerManager::list_controllers_srv_cb(
   const std::shared_ptr<controller_manager_msgs::srv::ListControllers::Request>,
   std::shared_ptr<controller_manager_msgs::srv::ListControllers::Response> response)
 {
-  // lock services
+  // Served from the last snapshot, no need to lock services nor controllers
   RCLCPP_DEBUG(get_logger(), "list controller service called");
-  std::lock_guard<std::mutex> services_guard(services_lock_);
-  RCLCPP_DEBUG(get_logger(), "list controller service locked");
-
-  // lock controllers
-  std::lock_guard<std::recursive_mutex> guard(rt_controllers_wrapper_.controllers_lock_);
-  const std::vector<ControllerSpec> & controllers =
-    rt_controllers_wrapper_.get_updated_list(guard);
-  response->controller.resize(controllers.size());
+  const auto snapshot = get_controller_states_snapshot();
+  response->controller = snapshot->states;
 
+#ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
+  const std::vector<ControllerSpec> & controllers = snapshot->controllers;
   for (size_t i = 0; i < controllers.size(); ++i) {
     controller_manager_msgs::msg::ControllerState & cs = response->controller[i];
-    cs.name = controllers[i].info.name;
-    cs.type = controllers[i].info.type;
-    cs.state = controllers[i].c->get_lifecycle_node()->get_current_state().label();
-
-#ifdef TODO_IMPLEMENT_RESOURCE_CHECKING
     cs.claimed_resources.clear();
     typedef std::vector<hardware_interface::InterfaceResources> ClaimedResVec;
     typedef ClaimedResVec::const_iterator ClaimedResIt;
@@ -652,14 +1320,54 @@ void ControllerManager::list_controllers_srv_cb(
         std::back_inserter(iface_res.resources));
       cs.claimed_resources.push_back(iface_res);
     }
-#endif
   }
+#endif
 
   RCLCPP_DEBUG(get_logger(), "list controller service finished");
 }
 
+void ControllerManager::list_controller_statistics_srv_cb(
+  const std::shared_ptr<controller_manager_msgs::srv::ListControllerStatistics::Request>,
+  std::shared_ptr<controller_manager_msgs::srv::ListControllerStatistics::Response> response)
+{
+  // Statistics are atomics written by the RT thread, no need to lock anything
+  RCLCPP_DEBUG(get_logger(), "list controller statistics service called");
+  const auto snapshot = get_controller_states_snapshot();
+  response->statistics.resize(snapshot->controllers.size());
+
+  for (size_t i = 0; i < snapshot->controllers.size(); ++i) {
+    const auto & controller = snapshot->controllers[i];
+    const auto & statistics = *controller.statistics;
+    auto & msg = response->statistics[i];
+    msg.name = controller.info.name;
+    msg.update_count = statistics.update_count;
+    msg.overrun_count = statistics.overrun_count;
+    msg.budget_us = controller.budget.budget_ns / 1e3;
+    msg.last_update_us = statistics.last_update_ns / 1e3;
+    msg.max_update_us = statistics.max_update_ns / 1e3;
+    msg.mean_update_us = msg.update_count > 0 ?
+      statistics.total_update_ns / 1e3 / static_cast<double>(msg.update_count) : 0.0;
+    msg.budget_utilization = controller.budget.budget_ns > 0 ?
+      msg.mean_update_us / msg.budget_us : 0.0;
+    msg.update_rate_divider = statistics.update_rate_divider;
+    msg.perf_update_count = statistics.perf_update_count;
+    const double perf_update_count =
+      msg.perf_update_count > 0 ? static_cast<double>(msg.perf_update_count) : 1.0;
+    msg.mean_instructions = statistics.perf_totals[
+      static_cast<size_t>(PerfCounter::INSTRUCTIONS)] / perf_update_count;
+    msg.mean_cache_misses = statistics.perf_totals[
+      static_cast<size_t>(PerfCounter::CACHE_MISSES)] / perf_update_count;
+    msg.mean_branch_misses = statistics.perf_totals[
+      static_cast<size_t>(PerfCounter::BRANCH_MISSES)] / perf_update_count;
+    msg.mean_page_faults = statistics.perf_totals[
+      static_cast<size_t>(PerfCounter::PAGE_FAULTS)] / perf_update_count;
+  }
+
+  RCLCPP_DEBUG(get_logger(), "list controller statistics service finished");
+}
+
 void ControllerManager::list_controller_types_srv_cb(
-  const std::shared_ptr<controller_manager_msgs::srv::ListControllerTypes::Request>,
+  const std::shared_ptr<controller_manager_msgs::srv::ListControllerTypes::Request> request,
   std::shared_ptr<controller_manager_msgs::srv::ListControllerTypes::Response> response)
 {
   // lock services
@@ -667,11 +1375,25 @@ void ControllerManager::list_controller_types_srv_cb(
   std::lock_guard<std::mutex> guard(services_lock_);
   RCLCPP_DEBUG(get_logger(), "list types service locked");
 
-  auto cur_types = loader_->getDeclaredClasses();
-  for (const auto & cur_type : cur_types) {
-    response->types.push_back(cur_type);
-    response->base_classes.push_back(kControllerInterface);
-    // RCLCPP_INFO(get_logger(), cur_type);
+  const auto catalogue = get_controller_type_catalogue();
+  const auto add_type = [&response](const ControllerTypeInfo & info)
+    {
+      response->types.push_back(info.type);
+      response->base_classes.push_back(info.base_class);
+    };
+  if (request->package.empty()) {
+    response->types.reserve(catalogue->types.size());
+    response->base_classes.reserve(catalogue->types.size());
+    for (const auto & info : catalogue->types) {
+      add_type(info);
+    }
+  } else {
+    const auto package_it = catalogue->index_by_package.find(request->package);
+    if (package_it != catalogue->index_by_package.end()) {
+      for (const auto index : package_it->second) {
+        add_type(catalogue->types[index]);
+      }
+    }
   }
 
   RCLCPP_DEBUG(get_logger(), "list types service finished");
@@ -702,6 +1424,13 @@ void ControllerManager::reload_controller_libraries_service_cb(
   std::lock_guard<std::mutex> guard(services_lock_);
   RCLCPP_DEBUG(get_logger(), "reload libraries service locked");
 
+  if (!request->controller_types.empty()) {
+    response->ok = reload_controller_libraries(request->controller_types, request->force_kill) ==
+      controller_interface::return_type::SUCCESS;
+    RCLCPP_DEBUG(get_logger(), "reload libraries service finished");
+    return;
+  }
+
   // only reload libraries if no controllers are running
   std::vector<std::string> loaded_controllers, running_controllers;
   loaded_controllers = get_controller_names();
@@ -756,6 +1485,7 @@ void ControllerManager::reload_controller_libraries_service_cb(
   // Force a reload on all the PluginLoaders (internally, this recreates the plugin loaders)
   loader_ = std::make_shared<pluginlib::ClassLoader<controller_interface::ControllerInterface>>(
     kControllerInterfaceName, kControllerInterface);
+  refresh_controller_type_catalogue();
   RCLCPP_INFO(
     get_logger(), "Controller manager: reloaded controller libraries for '%s'",
     kControllerInterfaceName);
@@ -765,6 +1495,17 @@ void ControllerManager::reload_controller_libraries_service_cb(
   RCLCPP_DEBUG(get_logger(), "reload libraries service finished");
 }
 
+void ControllerManager::step_service_cb(
+  const std::shared_ptr<controller_manager_msgs::srv::Step::Request> request,
+  std::shared_ptr<controller_manager_msgs::srv::Step::Response> response)
+{
+  // not locking the services, a switch request may be waiting for this step
+  response->ok = step(rclcpp::Duration(request->period), request->cycles) ==
+    controller_interface::return_type::SUCCESS;
+  response->time = get_simulated_time();
+  response->cycles_per_second = get_step_cycles_per_second();
+}
+
 void ControllerManager::switch_controller_service_cb(
   const std::shared_ptr<controller_manager_msgs::srv::SwitchController::Request> request,
   std::shared_ptr<controller_manager_msgs::srv::SwitchController::Response> response)
@@ -811,36 +1552,602 @@ std::vector<std::string> ControllerManager::get_controller_names()
   return names;
 }
 
+std::string ControllerManager::get_controller_executor_group(const std::string & controller_name)
+{
+  const std::string param_name = controller_name + ".executor_group";
+  if (!has_parameter(param_name)) {
+    declare_parameter(param_name, rclcpp::ParameterValue(std::string()));
+  }
+  std::string group_name;
+  get_parameter(param_name, group_name);
+  return group_name;
+}
+
+void ControllerManager::add_controller_to_executor(const ControllerSpec & controller)
+{
+  // Lightweight controllers only get a node once they ask for one
+  auto node = controller.c->get_node_base_interface();
+  if (!node || controller_nodes_.count(controller.info.name)) {
+    return;
+  }
+
+  const std::string group_name = get_controller_executor_group(controller.info.name);
+  controller_nodes_[controller.info.name] = ControllerNode{node, group_name};
+  if (group_name.empty()) {
+    executor_->add_node(node);
+    return;
+  }
+
+  auto & group = executor_groups_[group_name];
+  if (!group.executor) {
+    bool use_static_executors = false;
+    get_parameter(kUseStaticExecutorsParam, use_static_executors);
+    if (use_static_executors) {
+      group.executor = std::make_shared<rclcpp::executors::StaticSingleThreadedExecutor>();
+    } else {
+      group.executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+    }
+    group.executor->add_node(node);
+    group.thread = std::thread(
+      [executor = group.executor, stop_future = group.stop.get_future().share()]() {
+        executor->spin_until_future_complete(stop_future);
+      });
+
+    const std::string priority_param = "executor_groups." + group_name + ".thread_priority";
+    if (!has_parameter(priority_param)) {
+      declare_parameter(priority_param, 0);
+    }
+    int priority = 0;
+    get_parameter(priority_param, priority);
+#ifndef _WIN32
+    if (priority > 0) {
+      sched_param sched_parameters;
+      sched_parameters.sched_priority = priority;
+      if (pthread_setschedparam(group.thread.native_handle(), SCHED_FIFO, &sched_parameters)) {
+        RCLCPP_WARN(
+          get_logger(), "Could not set priority %i for executor group '%s'",
+          priority, group_name.c_str());
+      }
+    }
+#else
+    (void) priority;
+#endif
+    RCLCPP_DEBUG(get_logger(), "Started executor thread for group '%s'", group_name.c_str());
+  } else {
+    group.executor->add_node(node);
+  }
+  ++group.node_count;
+}
+
+void ControllerManager::remove_controller_from_executor(const ControllerSpec & controller)
+{
+  // Nodes created after the controller was last started were never added
+  auto node_it = controller_nodes_.find(controller.info.name);
+  if (node_it == controller_nodes_.end()) {
+    return;
+  }
+  const ControllerNode controller_node = node_it->second;
+  controller_nodes_.erase(node_it);
+
+  if (controller_node.executor_group.empty()) {
+    executor_->remove_node(controller_node.node);
+    return;
+  }
+
+  auto & group = executor_groups_.at(controller_node.executor_group);
+  group.executor->remove_node(controller_node.node);
+  if (--group.node_count == 0) {
+    stop_executor_group(group);
+    executor_groups_.erase(controller_node.executor_group);
+    RCLCPP_DEBUG(
+      get_logger(), "Stopped executor thread for group '%s'",
+      controller_node.executor_group.c_str());
+  }
+}
+
+void ControllerManager::stop_executor_group(ExecutorGroup & group)
+{
+  if (!group.thread.joinable()) {
+    return;
+  }
+  group.stop.set_value();
+  group.executor->cancel();
+  group.thread.join();
+}
+
+void ControllerManager::finish_switch(size_t rate_group)
+{
+  switch_pending_rate_groups_.fetch_and(~(1u << rate_group));
+}
+
+hardware_interface::RobotHardware & ControllerManager::get_owned_hardware(size_t rate_group) const
+{
+  return rate_group == DEFAULT_RATE_GROUP ? *hw_ : *rate_groups_[rate_group]->config.hardware;
+}
+
+controller_interface::return_type
+ControllerManager::add_rate_group(const RateGroupConfig & config)
+{
+  if (std::any_of(
+      rate_groups_.begin(), rate_groups_.end(),
+      [](const std::unique_ptr<RateGroup> & group) {return group->running.load();}))
+  {
+    RCLCPP_ERROR(
+      get_logger(), "Can't add rate group '%s' while rate groups are running",
+      config.name.c_str());
+    return controller_interface::return_type::ERROR;
+  }
+  if (config.name.empty() ||
+    std::any_of(
+      rate_groups_.begin(), rate_groups_.end(),
+      [&config](const std::unique_ptr<RateGroup> & group) {
+        return group->config.name == config.name;
+      }))
+  {
+    RCLCPP_ERROR(get_logger(), "A rate group named '%s' already exists", config.name.c_str());
+    return controller_interface::return_type::ERROR;
+  }
+  if (rate_groups_.size() >= MAX_RATE_GROUPS) {
+    RCLCPP_ERROR(
+      get_logger(), "Can't add rate group '%s', at most %zu groups are supported",
+      config.name.c_str(), MAX_RATE_GROUPS);
+    return controller_interface::return_type::ERROR;
+  }
+  if (config.period.count() <= 0) {
+    RCLCPP_ERROR(get_logger(), "Invalid period for rate group '%s'", config.name.c_str());
+    return controller_interface::return_type::ERROR;
+  }
+  if (!config.hardware) {
+    // sharing the manager hardware would race with the read() and write() of the update() loop
+    RCLCPP_ERROR(
+      get_logger(), "Rate group '%s' needs hardware of its own", config.name.c_str());
+    return controller_interface::return_type::ERROR;
+  }
+  if (config.hardware == hw_) {
+    RCLCPP_ERROR(
+      get_logger(), "Rate group '%s' can't use the manager hardware, the update() loop owns it",
+      config.name.c_str());
+    return controller_interface::return_type::ERROR;
+  }
+
+  auto group = std::make_unique<RateGroup>();
+  group->config = config;
+  rate_groups_.push_back(std::move(group));
+  return controller_interface::return_type::SUCCESS;
+}
+
+bool ControllerManager::get_controller_rate_group(
+  const std::string & controller_name,
+  size_t & rate_group)
+{
+  const std::string param_name = controller_name + ".rate_group";
+  if (!has_parameter(param_name)) {
+    declare_parameter(param_name, rclcpp::ParameterValue(std::string()));
+  }
+  std::string group_name;
+  get_parameter(param_name, group_name);
+  if (group_name.empty()) {
+    rate_group = DEFAULT_RATE_GROUP;
+    return true;
+  }
+  for (size_t i = DEFAULT_RATE_GROUP + 1; i < rate_groups_.size(); ++i) {
+    if (rate_groups_[i]->config.name == group_name) {
+      rate_group = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ControllerManager::start_rate_groups()
+{
+  if (lockstep_) {
+    RCLCPP_ERROR(get_logger(), "Can't start rate groups, the controller manager is being stepped");
+    return;
+  }
+  for (size_t i = DEFAULT_RATE_GROUP + 1; i < rate_groups_.size(); ++i) {
+    auto & group = *rate_groups_[i];
+    if (group.running) {
+      continue;
+    }
+    group.running = true;
+    group.thread = std::thread(&ControllerManager::run_rate_group, this, i);
+#ifndef _WIN32
+    if (group.config.thread_priority > 0) {
+      sched_param sched_parameters;
+      sched_parameters.sched_priority = group.config.thread_priority;
+      if (pthread_setschedparam(group.thread.native_handle(), SCHED_FIFO, &sched_parameters)) {
+        RCLCPP_WARN(
+          get_logger(), "Could not set priority %i for rate group '%s'",
+          group.config.thread_priority, group.config.name.c_str());
+      }
+    }
+#endif
+#ifdef __linux__
+    if (!group.config.cpu_affinity.empty()) {
+      cpu_set_t cpu_set;
+      CPU_ZERO(&cpu_set);
+      for (const auto cpu : group.config.cpu_affinity) {
+        CPU_SET(cpu, &cpu_set);
+      }
+      if (pthread_setaffinity_np(group.thread.native_handle(), sizeof(cpu_set), &cpu_set)) {
+        RCLCPP_WARN(
+          get_logger(), "Could not set CPU affinity for rate group '%s'",
+          group.config.name.c_str());
+      }
+    }
+#endif
+    RCLCPP_DEBUG(get_logger(), "Started thread for rate group '%s'", group.config.name.c_str());
+  }
+}
+
+void ControllerManager::stop_rate_groups()
+{
+  for (size_t i = DEFAULT_RATE_GROUP + 1; i < rate_groups_.size(); ++i) {
+    auto & group = *rate_groups_[i];
+    if (!group.thread.joinable()) {
+      continue;
+    }
+    group.running = false;
+    group.thread.join();
+    rt_controllers_wrapper_.release_rt_list(i);
+    // don't leave a pending switch waiting for this group
+    switch_stopping_rate_groups_.fetch_and(~(1u << i));
+    auto pending = ModeSwitchState::PENDING;
+    mode_switch_states_[i].compare_exchange_strong(pending, ModeSwitchState::FAILED);
+    finish_switch(i);
+    RCLCPP_DEBUG(get_logger(), "Stopped thread for rate group '%s'", group.config.name.c_str());
+  }
+}
+
+void ControllerManager::run_rate_group(size_t rate_group)
+{
+  auto & group = *rate_groups_[rate_group];
+  if (use_perf_counters_) {
+    // opened before the first cycle instead of during it
+    open_perf_counters(group);
+  }
+  auto next_cycle = std::chrono::steady_clock::now();
+  bool hardware_clock_lost = false;
+  bool read_failed = false;
+  bool write_failed = false;
+  while (group.running && rclcpp::ok()) {
+    // the hardware signals a new frame, run the cycle right away to stay in phase with it
+    const bool clocked_by_hardware = group.config.hardware_clocked &&
+      group.config.hardware->wait_for_cycle() == hardware_interface::return_type::OK;
+    if (group.config.hardware_clocked && clocked_by_hardware == hardware_clock_lost) {
+      hardware_clock_lost = !clocked_by_hardware;
+      if (hardware_clock_lost) {
+        RCLCPP_ERROR(
+          get_logger(), "Rate group '%s' lost the hardware clock, falling back to its period",
+          group.config.name.c_str());
+      } else {
+        RCLCPP_INFO(
+          get_logger(), "Rate group '%s' is clocked by the hardware", group.config.name.c_str());
+      }
+    }
+
+    // logged when the hardware fails or recovers only, not on every cycle of the realtime loop
+    auto & hardware = *group.config.hardware;
+    CONTROLLER_MANAGER_TRACEPOINT(hardware_read_start, rate_group);
+    const auto read_ret = hardware.read();
+    CONTROLLER_MANAGER_TRACEPOINT(hardware_read_end, rate_group, static_cast<int>(read_ret));
+    if ((read_ret != hardware_interface::return_type::OK) != read_failed) {
+      read_failed = !read_failed;
+      if (read_failed) {
+        RCLCPP_ERROR(
+          get_logger(), "Rate group '%s' failed to read the hardware", group.config.name.c_str());
+      } else {
+        RCLCPP_INFO(
+          get_logger(), "Rate group '%s' reads the hardware again", group.config.name.c_str());
+      }
+    }
+    hardware.get_interface_registry().take_snapshot();
+    update_rate_group(rate_group);
+    hardware.enforce_command_watchdog();
+    CONTROLLER_MANAGER_TRACEPOINT(hardware_write_start, rate_group);
+    const auto write_ret = hardware.write();
+    CONTROLLER_MANAGER_TRACEPOINT(hardware_write_end, rate_group, static_cast<int>(write_ret));
+    if ((write_ret != hardware_interface::return_type::OK) != write_failed) {
+      write_failed = !write_failed;
+      if (write_failed) {
+        RCLCPP_ERROR(
+          get_logger(), "Rate group '%s' failed to write the hardware", group.config.name.c_str());
+      } else {
+        RCLCPP_INFO(
+          get_logger(), "Rate group '%s' writes the hardware again", group.config.name.c_str());
+      }
+    }
+
+    if (clocked_by_hardware) {
+      next_cycle = std::chrono::steady_clock::now();
+      continue;
+    }
+    next_cycle += group.config.period;
+    const auto now = std::chrono::steady_clock::now();
+    if (next_cycle < now) {
+      // overran a whole period, skip the missed cycles instead of catching up
+      next_cycle = now;
+    }
+    std::this_thread::sleep_until(next_cycle);
+  }
+}
+
+void ControllerManager::init_perf_counters()
+{
+  if (use_perf_counters_) {
+    open_perf_counters(*rate_groups_[DEFAULT_RATE_GROUP]);
+  }
+}
+
+void ControllerManager::open_perf_counters(RateGroup & group)
+{
+  // perf counts the thread that opened the counters only
+  const auto thread = std::this_thread::get_id();
+  if (group.perf_counters && group.perf_thread == thread) {
+    return;
+  }
+  group.perf_thread = thread;
+  if (!group.perf_counters) {
+    group.perf_counters = std::make_unique<PerfCounters>();
+  }
+  const char * group_name =
+    group.config.name.empty() ? "default" : group.config.name.c_str();
+  std::string error;
+  if (!group.perf_counters->open(error)) {
+    RCLCPP_WARN(
+      get_logger(), "Perf counters disabled for rate group '%s': %s", group_name, error.c_str());
+    return;
+  }
+  if (!error.empty()) {
+    RCLCPP_WARN(get_logger(), "Rate group '%s': %s", group_name, error.c_str());
+  }
+}
+
+const PerfCounters * ControllerManager::get_perf_counters(const RateGroup & group) const
+{
+  if (!group.perf_counters || !group.perf_counters->is_open() ||
+    group.perf_thread != std::this_thread::get_id())
+  {
+    return nullptr;
+  }
+  return group.perf_counters.get();
+}
+
 controller_interface::return_type
 ControllerManager::update()
 {
+  // the caller read the hardware right before, does nothing unless snapshots are enabled
+  hw_->get_interface_registry().take_snapshot();
+  const auto ret = update_rate_group(DEFAULT_RATE_GROUP);
+  hw_->enforce_command_watchdog();
+  return ret;
+}
+
+controller_interface::return_type
+ControllerManager::update_rate_group(size_t rate_group)
+{
+  auto & group = *rate_groups_[rate_group];
+  const rclcpp::Time time = get_clock()->now();
+  const int64_t period_ns = group.last_update_ns ? time.nanoseconds() - group.last_update_ns : 0;
+  group.last_update_ns = time.nanoseconds();
+  return update_controllers(rate_group, time, rclcpp::Duration(period_ns));
+}
+
+controller_interface::return_type ControllerManager::step(
+  const rclcpp::Duration & period,
+  size_t cycles)
+{
+  if (period.nanoseconds() <= 0) {
+    RCLCPP_ERROR(
+      get_logger(), "Can't step by a period of %lld ns",
+      static_cast<long long>(period.nanoseconds()));
+    return controller_interface::return_type::ERROR;
+  }
+  if (std::any_of(
+      rate_groups_.begin(), rate_groups_.end(),
+      [](const std::unique_ptr<RateGroup> & group) {return group->running.load();}))
+  {
+    RCLCPP_ERROR(get_logger(), "Can't step while rate groups are running");
+    return controller_interface::return_type::ERROR;
+  }
+  lockstep_ = true;
+  if (use_perf_counters_) {
+    // the groups are updated by the thread serving the step
+    for (auto & group : rate_groups_) {
+      open_perf_counters(*group);
+    }
+  }
+
+  auto ret = controller_interface::return_type::SUCCESS;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t cycle = 0; cycle < cycles; ++cycle) {
+    simulated_time_ = simulated_time_ + period;
+    const int64_t now_ns = simulated_time_.nanoseconds();
+
+    // the default group runs every step, the others at their own period of simulated time,
+    // and the hardware of a group is only read and written when the group updates
+    uint32_t due_rate_groups = 1u << DEFAULT_RATE_GROUP;
+    for (size_t i = DEFAULT_RATE_GROUP + 1; i < rate_groups_.size(); ++i) {
+      auto & group = *rate_groups_[i];
+      if (now_ns < group.next_step_ns) {
+        continue;
+      }
+      due_rate_groups |= 1u << i;
+      group.next_step_ns += group.config.period.count();
+      if (group.next_step_ns <= now_ns) {
+        group.next_step_ns = now_ns + group.config.period.count();
+      }
+    }
+    auto for_each_due_rate_group = [this, due_rate_groups](auto function) {
+        for (size_t i = 0; i < rate_groups_.size(); ++i) {
+          if (due_rate_groups & (1u << i)) {
+            function(i);
+          }
+        }
+      };
+
+    for_each_due_rate_group(
+      [this, &ret](size_t rate_group) {
+        auto & hardware = get_owned_hardware(rate_group);
+        CONTROLLER_MANAGER_TRACEPOINT(hardware_read_start, rate_group);
+        const auto read_ret = hardware.read();
+        CONTROLLER_MANAGER_TRACEPOINT(hardware_read_end, rate_group, static_cast<int>(read_ret));
+        if (read_ret != hardware_interface::return_type::OK) {
+          RCLCPP_ERROR(get_logger(), "Failed to read the hardware while stepping");
+          ret = controller_interface::return_type::ERROR;
+        }
+        hardware.get_interface_registry().take_snapshot();
+      });
+    for_each_due_rate_group(
+      [this, &ret, &period, now_ns](size_t rate_group) {
+        auto & group = *rate_groups_[rate_group];
+        const int64_t period_ns =
+          group.last_step_ns ? now_ns - group.last_step_ns : period.nanoseconds();
+        group.last_step_ns = now_ns;
+        if (update_controllers(rate_group, simulated_time_, rclcpp::Duration(period_ns)) !=
+          controller_interface::return_type::SUCCESS)
+        {
+          ret = controller_interface::return_type::ERROR;
+        }
+      });
+    for_each_due_rate_group(
+      [this, &ret](size_t rate_group) {
+        auto & hardware = get_owned_hardware(rate_group);
+        hardware.enforce_command_watchdog();
+        CONTROLLER_MANAGER_TRACEPOINT(hardware_write_start, rate_group);
+        const auto write_ret = hardware.write();
+        CONTROLLER_MANAGER_TRACEPOINT(
+          hardware_write_end, rate_group, static_cast<int>(write_ret));
+        if (write_ret != hardware_interface::return_type::OK) {
+          RCLCPP_ERROR(get_logger(), "Failed to write the hardware while stepping");
+          ret = controller_interface::return_type::ERROR;
+        }
+      });
+  }
+
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  step_cycles_per_second_ = elapsed.count() > 0.0 ? cycles / elapsed.count() : 0.0;
+  RCLCPP_DEBUG(
+    get_logger(), "Stepped %zu cycles at %.0f cycles per second", cycles,
+    step_cycles_per_second_);
+  return ret;
+}
+
+rclcpp::Time ControllerManager::get_simulated_time() const
+{
+  return simulated_time_;
+}
+
+double ControllerManager::get_step_cycles_per_second() const
+{
+  return step_cycles_per_second_;
+}
+
+controller_interface::return_type
+ControllerManager::update_controllers(
+  size_t rate_group, const rclcpp::Time & time,
+  const rclcpp::Duration & period)
+{
+  CONTROLLER_MANAGER_TRACEPOINT(update_start, rate_group);
   std::vector<ControllerSpec> & rt_controller_list =
-    rt_controllers_wrapper_.update_and_get_used_by_rt_list();
+    rt_controllers_wrapper_.update_and_get_used_by_rt_list(rate_group);
 
+  auto & group = *rate_groups_[rate_group];
+  const uint64_t update_cycle = ++group.update_cycle;
+  const PerfCounters * perf_counters = use_perf_counters_ ? get_perf_counters(group) : nullptr;
   auto ret = controller_interface::return_type::SUCCESS;
-  for (auto loaded_controller : rt_controller_list) {
+  for (auto & loaded_controller : rt_controller_list) {
+    if (loaded_controller.rate_group != rate_group) {
+      continue;
+    }
+    // standby fallbacks wait for a controller to fail, failed ones for the non-RT thread
+    if (loaded_controller.selection->standby || loaded_controller.selection->failed) {
+      continue;
+    }
     // TODO(v-lopez) we could cache this information
     // https://github.com/ros-controls/ros2_control/issues/153
     if (is_controller_running(*loaded_controller.c)) {
+      auto & statistics = *loaded_controller.statistics;
+      // demoted controllers are only updated every update_rate_divider cycles
+      if (update_cycle % statistics.update_rate_divider != 0) {
+        continue;
+      }
+
+      // demoted controllers skipped the cycles in between
+      loaded_controller.c->set_update_time(
+        time, rclcpp::Duration(period.nanoseconds() * statistics.update_rate_divider));
+      CONTROLLER_MANAGER_TRACEPOINT(
+        controller_update_start, loaded_controller.info.name.c_str());
+      // read outside of the timed section, not to count reading the counters in the budget
+      PerfSample perf_start;
+      const bool perf_started = perf_counters && perf_counters->read(perf_start);
+      const int64_t update_start_ns = get_update_clock_ns();
       auto controller_ret = loaded_controller.c->update();
+      const int64_t update_duration_ns = get_update_clock_ns() - update_start_ns;
+      PerfSample perf_end;
+      if (perf_started && perf_counters->read(perf_end)) {
+        ++statistics.perf_update_count;
+        for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+          statistics.perf_totals[i] += perf_end[i] - perf_start[i];
+        }
+      }
+      CONTROLLER_MANAGER_TRACEPOINT(
+        controller_update_end, loaded_controller.info.name.c_str(),
+        static_cast<int>(controller_ret));
+
+      ++statistics.update_count;
+      statistics.last_update_ns = update_duration_ns;
+      statistics.total_update_ns += update_duration_ns;
+      if (update_duration_ns > statistics.max_update_ns) {
+        statistics.max_update_ns = update_duration_ns;
+      }
+      if (loaded_controller.budget.budget_ns > 0 &&
+        update_duration_ns > loaded_controller.budget.budget_ns)
+      {
+        apply_budget_policy(rt_controller_list, loaded_controller);
+      }
+
       if (controller_ret != controller_interface::return_type::SUCCESS) {
         ret = controller_ret;
+        if (!loaded_controller.fallback_indices.empty() && !loaded_controller.selection->failed) {
+          switch_to_fallback_controllers(rt_controller_list, loaded_controller);
+        }
       }
     }
   }
 
-  // there are controllers to start/stop
-  if (switch_params_.do_switch) {
-    manage_switch();
+  // there are controllers of this group to start/stop
+  if (switch_pending_rate_groups_ & (1u << rate_group)) {
+    manage_switch(rate_group);
   }
+  CONTROLLER_MANAGER_TRACEPOINT(update_end, rate_group, static_cast<int>(ret));
   return ret;
 }
 
+ControllerManager::RTControllerListWrapper::RTControllerListWrapper()
+{
+  for (auto & used_by_realtime_controllers_index : used_by_realtime_controllers_indices_) {
+    used_by_realtime_controllers_index = -1;
+  }
+}
+
 std::vector<ControllerSpec> &
-ControllerManager::RTControllerListWrapper::update_and_get_used_by_rt_list()
+ControllerManager::RTControllerListWrapper::update_and_get_used_by_rt_list(size_t rate_group)
 {
-  used_by_realtime_controllers_index_ = updated_controllers_index_;
-  return controllers_lists_[used_by_realtime_controllers_index_];
+  // Read the updated index again after publishing it, in case the lists were switched
+  // in between and the non-RT thread missed that this group is using the former one
+  int index;
+  do {
+    index = updated_controllers_index_;
+    used_by_realtime_controllers_indices_[rate_group] = index;
+  } while (index != updated_controllers_index_);
+  return controllers_lists_[index];
+}
+
+void ControllerManager::RTControllerListWrapper::release_rt_list(size_t rate_group)
+{
+  used_by_realtime_controllers_indices_[rate_group] = -1;
 }
 
 std::vector<ControllerSpec> &
@@ -871,6 +2178,8 @@ void ControllerManager::RTControllerListWrapper::switch_updated_list(
   assert(controllers_lock_.try_lock());
   controllers_lock_.unlock();
   int former_current_controllers_list_ = updated_controllers_index_;
+  CONTROLLER_MANAGER_TRACE_SCOPE(
+    list_switch_start, list_switch_end, get_other_list(former_current_controllers_list_));
   updated_controllers_index_ = get_other_list(former_current_controllers_list_);
   wait_until_rt_not_using(former_current_controllers_list_);
 }
@@ -885,7 +2194,12 @@ void ControllerManager::RTControllerListWrapper::wait_until_rt_not_using(
   std::chrono::microseconds sleep_period)
 const
 {
-  while (used_by_realtime_controllers_index_ == index) {
+  auto is_used_by_rt = [this, index]() {
+      return std::any_of(
+        used_by_realtime_controllers_indices_.begin(), used_by_realtime_controllers_indices_.end(),
+        [index](const std::atomic<int> & used_index) {return used_index == index;});
+    };
+  while (is_used_by_rt()) {
     if (!rclcpp::ok()) {
       throw std::runtime_error("rclcpp interrupted");
     }
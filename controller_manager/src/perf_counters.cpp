@@ -0,0 +1,163 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "controller_manager/perf_counters.hpp"
+
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace controller_manager
+{
+
+#ifdef __linux__
+namespace
+{
+struct CounterConfig
+{
+  std::uint32_t type;
+  std::uint64_t config;
+  const char * name;
+};
+
+// indexed by PerfCounter
+constexpr CounterConfig kCounterConfigs[PERF_COUNTER_COUNT] = {
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache misses"},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch misses"},
+  {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, "page faults"},
+};
+
+int perf_event_open(const CounterConfig & counter, int group_fd)
+{
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = counter.type;
+  attr.config = counter.config;
+  // the whole group is enabled at once when complete
+  attr.disabled = group_fd == -1 ? 1 : 0;
+  // user space only, allowed by the default perf_event_paranoid
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // pid 0 and cpu -1 count the calling thread on any CPU
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+}  // namespace
+#endif
+
+PerfCounters::~PerfCounters()
+{
+  close();
+}
+
+bool PerfCounters::open(std::string & error)
+{
+  close();
+#ifdef __linux__
+  std::string failures;
+  for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+    const int fd = perf_event_open(kCounterConfigs[i], group_fd_);
+    if (fd == -1) {
+      failures += std::string(failures.empty() ? "" : ", ") + kCounterConfigs[i].name + ": " +
+        std::strerror(errno);
+      continue;
+    }
+    if (group_fd_ == -1) {
+      group_fd_ = fd;
+    }
+    fds_[i] = fd;
+    read_order_[open_count_++] = static_cast<PerfCounter>(i);
+  }
+  if (group_fd_ == -1) {
+    error = "no perf counter available (" + failures + ")";
+    return false;
+  }
+  if (ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP) == -1 ||
+    ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == -1)
+  {
+    error = std::string("can't enable the perf counters: ") + std::strerror(errno);
+    close();
+    return false;
+  }
+  if (!failures.empty()) {
+    error = "some perf counters are not available (" + failures + ")";
+  }
+  return true;
+#else
+  error = "perf counters are only available on Linux";
+  return false;
+#endif
+}
+
+void PerfCounters::close()
+{
+#ifdef __linux__
+  // members first, the group leader last
+  for (auto & fd : fds_) {
+    if (fd != -1 && fd != group_fd_) {
+      ::close(fd);
+    }
+    fd = -1;
+  }
+  if (group_fd_ != -1) {
+    ::close(group_fd_);
+  }
+#endif
+  group_fd_ = -1;
+  open_count_ = 0;
+}
+
+bool PerfCounters::is_open() const
+{
+  return group_fd_ != -1;
+}
+
+bool PerfCounters::has(PerfCounter counter) const
+{
+  return fds_[static_cast<size_t>(counter)] != -1;
+}
+
+bool PerfCounters::read(PerfSample & sample) const
+{
+  sample.fill(0);
+#ifdef __linux__
+  if (group_fd_ == -1) {
+    return false;
+  }
+  // PERF_FORMAT_GROUP: the number of counters followed by their values
+  std::uint64_t buffer[1 + PERF_COUNTER_COUNT];
+  const auto expected_size = static_cast<ssize_t>((1 + open_count_) * sizeof(std::uint64_t));
+  if (::read(group_fd_, buffer, sizeof(buffer)) != expected_size || buffer[0] != open_count_) {
+    return false;
+  }
+  for (size_t i = 0; i < open_count_; ++i) {
+    sample[static_cast<size_t>(read_order_[i])] = buffer[1 + i];
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace controller_manager
@@ -0,0 +1,142 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// LTTng tracepoint provider of the control loop, only built with CONTROLLER_MANAGER_TRACING.
+// Each phase is traced by a *_start and a *_end event, see scripts/analyze_trace.py.
+
+#undef TRACEPOINT_PROVIDER
+#define TRACEPOINT_PROVIDER ros2_control
+
+#undef TRACEPOINT_INCLUDE
+#define TRACEPOINT_INCLUDE "tp_call.h"
+
+// LTTng includes the provider header several times, hence the multi-read guard
+#if !defined(_TP_CALL_H_) || defined(TRACEPOINT_HEADER_MULTI_READ)  // NOLINT(build/header_guard)
+#define _TP_CALL_H_
+
+#include <lttng/tracepoint.h>
+
+#include <stdint.h>
+
+TRACEPOINT_EVENT_CLASS(
+  ros2_control,
+  rate_group_class,
+  TP_ARGS(uint64_t, rate_group),
+  TP_FIELDS(ctf_integer(uint64_t, rate_group, rate_group))
+)
+
+TRACEPOINT_EVENT_CLASS(
+  ros2_control,
+  rate_group_ret_class,
+  TP_ARGS(uint64_t, rate_group, int, ret),
+  TP_FIELDS(
+    ctf_integer(uint64_t, rate_group, rate_group)
+    ctf_integer(int, ret, ret)
+  )
+)
+
+TRACEPOINT_EVENT_CLASS(
+  ros2_control,
+  controller_class,
+  TP_ARGS(const char *, controller_name),
+  TP_FIELDS(ctf_string(controller_name, controller_name))
+)
+
+TRACEPOINT_EVENT_CLASS(
+  ros2_control,
+  controller_ret_class,
+  TP_ARGS(const char *, controller_name, int, ret),
+  TP_FIELDS(
+    ctf_string(controller_name, controller_name)
+    ctf_integer(int, ret, ret)
+  )
+)
+
+TRACEPOINT_EVENT_CLASS(
+  ros2_control,
+  switch_class,
+  TP_ARGS(uint64_t, start_count, uint64_t, stop_count),
+  TP_FIELDS(
+    ctf_integer(uint64_t, start_count, start_count)
+    ctf_integer(uint64_t, stop_count, stop_count)
+  )
+)
+
+TRACEPOINT_EVENT_CLASS(
+  ros2_control,
+  list_class,
+  TP_ARGS(int, list_index),
+  TP_FIELDS(ctf_integer(int, list_index, list_index))
+)
+
+// ControllerManager::update_controllers(), run by update() and each rate group
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, rate_group_class, update_start,
+  TP_ARGS(uint64_t, rate_group))
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, rate_group_ret_class, update_end,
+  TP_ARGS(uint64_t, rate_group, int, ret))
+
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, controller_class, controller_update_start,
+  TP_ARGS(const char *, controller_name))
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, controller_ret_class, controller_update_end,
+  TP_ARGS(const char *, controller_name, int, ret))
+
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, rate_group_class, manage_switch_start,
+  TP_ARGS(uint64_t, rate_group))
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, rate_group_class, manage_switch_end,
+  TP_ARGS(uint64_t, rate_group))
+
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, switch_class, switch_controller_start,
+  TP_ARGS(uint64_t, start_count, uint64_t, stop_count))
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, switch_class, switch_controller_end,
+  TP_ARGS(uint64_t, start_count, uint64_t, stop_count))
+
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, controller_class, add_controller_start,
+  TP_ARGS(const char *, controller_name))
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, controller_class, add_controller_end,
+  TP_ARGS(const char *, controller_name))
+
+// RTControllerListWrapper::switch_updated_list(), up to the RT threads leaving the former list
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, list_class, list_switch_start,
+  TP_ARGS(int, list_index))
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, list_class, list_switch_end,
+  TP_ARGS(int, list_index))
+
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, rate_group_class, hardware_read_start,
+  TP_ARGS(uint64_t, rate_group))
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, rate_group_ret_class, hardware_read_end,
+  TP_ARGS(uint64_t, rate_group, int, ret))
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, rate_group_class, hardware_write_start,
+  TP_ARGS(uint64_t, rate_group))
+TRACEPOINT_EVENT_INSTANCE(
+  ros2_control, rate_group_ret_class, hardware_write_end,
+  TP_ARGS(uint64_t, rate_group, int, ret))
+
+#endif  // _TP_CALL_H_
+
+#include <lttng/tracepoint-event.h>
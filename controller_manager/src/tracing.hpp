@@ -0,0 +1,62 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRACING_HPP_
+#define TRACING_HPP_
+
+// Traces an event of tp_call.h, compiled out unless built with CONTROLLER_MANAGER_TRACING
+#ifdef CONTROLLER_MANAGER_TRACING_ENABLED
+#include "tp_call.h"
+
+namespace controller_manager
+{
+namespace tracing
+{
+/// Calls a function when leaving the scope, to trace the end of functions with many returns
+template<typename Function>
+class ScopeExit
+{
+public:
+  explicit ScopeExit(Function & function)
+  : function_(function) {}
+
+  ScopeExit(const ScopeExit &) = delete;
+  ScopeExit & operator=(const ScopeExit &) = delete;
+
+  ~ScopeExit()
+  {
+    function_();
+  }
+
+private:
+  Function & function_;
+};
+}  // namespace tracing
+}  // namespace controller_manager
+
+#define CONTROLLER_MANAGER_TRACEPOINT(event_name, ...) \
+  tracepoint(ros2_control, event_name, __VA_ARGS__)
+
+// Traces start_event now and end_event with the same arguments when leaving the scope
+#define CONTROLLER_MANAGER_TRACE_SCOPE(start_event, end_event, ...) \
+  CONTROLLER_MANAGER_TRACEPOINT(start_event, __VA_ARGS__); \
+  auto trace_scope_end = [&]() {CONTROLLER_MANAGER_TRACEPOINT(end_event, __VA_ARGS__);}; \
+  controller_manager::tracing::ScopeExit<decltype(trace_scope_end)> trace_scope_guard( \
+    trace_scope_end)
+#else
+#define CONTROLLER_MANAGER_TRACEPOINT(event_name, ...) ((void)0)
+#define CONTROLLER_MANAGER_TRACE_SCOPE(start_event, end_event, ...) ((void)0)
+#endif
+
+#endif  // TRACING_HPP_
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -24,6 +25,8 @@
 #include "test_robot_hardware/test_robot_hardware.hpp"
 #include "./test_controller/test_controller.hpp"
 
+using ::testing::Return;
+
 TEST_F(TestControllerManager, controller_lifecycle) {
   auto cm = std::make_shared<controller_manager::ControllerManager>(
     robot_, executor_,
@@ -34,8 +37,9 @@ TEST_F(TestControllerManager, controller_lifecycle) {
   cm->add_controller(
     test_controller, test_controller::TEST_CONTROLLER_NAME,
     test_controller::TEST_CONTROLLER_TYPE);
-  EXPECT_EQ(1u, cm->get_loaded_controllers().size());
-  EXPECT_EQ(2, test_controller.use_count());
+  EXPECT_EQ(1u, cm->get_loaded_controllers()->size());
+  // held by the test, the controller list and the published controller states snapshot
+  EXPECT_EQ(3, test_controller.use_count());
 
   EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
   EXPECT_EQ(
@@ -124,3 +128,712 @@ TEST_F(TestControllerManager, controller_lifecycle) {
     test_controller->get_lifecycle_node()->get_current_state().id());
   EXPECT_EQ(1, test_controller.use_count());
 }
+
+TEST_F(TestControllerManager, lightweight_controller_lifecycle) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  cm->set_parameter(rclcpp::Parameter("lightweight_controllers", true));
+
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(
+    test_controller, test_controller::TEST_CONTROLLER_NAME,
+    test_controller::TEST_CONTROLLER_TYPE);
+  EXPECT_EQ(1u, cm->get_loaded_controllers()->size());
+  EXPECT_TRUE(test_controller->is_lightweight());
+  EXPECT_FALSE(test_controller->has_lifecycle_node()) <<
+    "No node should be created for a controller that doesn't ask for one";
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
+    test_controller->get_current_state().id());
+
+  std::vector<std::string> start_controllers = {test_controller::TEST_CONTROLLER_NAME};
+  std::vector<std::string> stop_controllers = {};
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    start_controllers, stop_controllers,
+    STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    test_controller->get_current_state().id());
+
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(1u, test_controller->internal_counter);
+
+  start_controllers = {};
+  stop_controllers = {test_controller::TEST_CONTROLLER_NAME};
+  switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    start_controllers, stop_controllers,
+    STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+
+  auto unload_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::unload_controller, cm,
+    test_controller::TEST_CONTROLLER_NAME);
+  ASSERT_EQ(
+    std::future_status::timeout,
+    unload_future.wait_for(std::chrono::milliseconds(100))) <<
+    "unload_controller should be blocking until next update cycle";
+  cm->update();
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, unload_future.get());
+
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_UNCONFIGURED,
+    test_controller->get_current_state().id());
+  EXPECT_EQ(1, test_controller.use_count());
+}
+
+namespace
+{
+class LazyNodeController : public test_controller::TestController
+{
+public:
+  rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
+  on_activate(const rclcpp_lifecycle::State &) override
+  {
+    if (create_node_on_activate) {
+      get_node();
+    }
+    return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::SUCCESS;
+  }
+
+  controller_interface::return_type update() override
+  {
+    if (create_node_on_update) {
+      get_node();
+    }
+    return test_controller::TestController::update();
+  }
+
+  bool create_node_on_activate = false;
+  bool create_node_on_update = false;
+};
+}  // namespace
+
+TEST_F(TestControllerManager, lightweight_controller_lazy_node) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  cm->set_parameter(rclcpp::Parameter("lightweight_controllers", true));
+
+  auto activate_controller = std::make_shared<LazyNodeController>();
+  activate_controller->create_node_on_activate = true;
+  auto update_controller = std::make_shared<LazyNodeController>();
+  update_controller->create_node_on_update = true;
+  cm->add_controller(
+    activate_controller, "activate_controller", test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(
+    update_controller, "update_controller", test_controller::TEST_CONTROLLER_TYPE);
+  EXPECT_EQ(nullptr, activate_controller->get_node_base_interface());
+  EXPECT_EQ(nullptr, activate_controller->get_lifecycle_node());
+
+  const std::vector<std::string> controllers = {"activate_controller", "update_controller"};
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    controllers, std::vector<std::string>{}, STRICT, true, rclcpp::Duration(0, 0));
+  while (switch_future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+    cm->update();
+  }
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  ASSERT_NE(nullptr, activate_controller->get_node_base_interface());
+  EXPECT_THROW(
+    executor_->add_node(activate_controller->get_node_base_interface()),
+    std::runtime_error) << "The node created while starting should be spun";
+  cm->update();
+  ASSERT_NE(nullptr, update_controller->get_node_base_interface());
+
+  switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{}, controllers, STRICT, true, rclcpp::Duration(0, 0));
+  while (switch_future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+    cm->update();
+  }
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  for (const auto & controller : controllers) {
+    auto unload_future = std::async(
+      std::launch::async,
+      &controller_manager::ControllerManager::unload_controller, cm, controller);
+    while (unload_future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+      cm->update();
+    }
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, unload_future.get()) << controller;
+  }
+}
+
+TEST_F(TestControllerManager, update_enforces_command_watchdog) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  ASSERT_EQ(
+    hardware_interface::return_type::OK,
+    robot_->watch_joint_command("joint1", "position_command", 0.0));
+  hardware_interface::JointHandle command("joint1", "position_command");
+  ASSERT_EQ(hardware_interface::return_type::OK, robot_->get_joint_handle(command));
+
+  command.set_value(1.0);
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(1.0, command.get_value()) << "The command was written during the cycle";
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(0.0, command.get_value()) << "The stale command should be replaced before write()";
+}
+
+TEST_F(TestControllerManager, update_takes_the_hardware_snapshot) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  auto & registry = robot_->get_interface_registry();
+  registry.enable_snapshot();
+  const auto index =
+    registry.find(hardware_interface::InterfaceNamespace::JOINT, "joint1", "position");
+  ASSERT_NE(hardware_interface::InterfaceRegistry::npos, index);
+
+  registry.data()[index] = 4.0;
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  ASSERT_NE(nullptr, registry.get_snapshot());
+  EXPECT_EQ(4.0, registry.get_snapshot()[index]);
+  registry.data()[index] = 5.0;
+  EXPECT_EQ(4.0, registry.get_snapshot()[index]) << "The snapshot holds until the next update()";
+}
+
+TEST_F(TestControllerManager, controller_states_snapshot) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+
+  auto initial_snapshot = cm->get_controller_states_snapshot();
+  ASSERT_NE(nullptr, initial_snapshot);
+  EXPECT_EQ(0u, initial_snapshot->states.size());
+
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(
+    test_controller, test_controller::TEST_CONTROLLER_NAME,
+    test_controller::TEST_CONTROLLER_TYPE);
+
+  auto loaded_snapshot = cm->get_controller_states_snapshot();
+  EXPECT_GT(loaded_snapshot->version, initial_snapshot->version);
+  ASSERT_EQ(1u, loaded_snapshot->states.size());
+  EXPECT_EQ(test_controller::TEST_CONTROLLER_NAME, loaded_snapshot->states[0].name);
+  EXPECT_EQ(test_controller::TEST_CONTROLLER_TYPE, loaded_snapshot->states[0].type);
+  EXPECT_EQ("inactive", loaded_snapshot->states[0].state);
+  EXPECT_EQ(0u, initial_snapshot->states.size()) << "Published snapshots are immutable";
+
+  std::vector<std::string> start_controllers = {test_controller::TEST_CONTROLLER_NAME};
+  std::vector<std::string> stop_controllers = {};
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    start_controllers, stop_controllers,
+    STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  cm->update();
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+
+  auto switched_snapshot = cm->get_controller_states_snapshot();
+  EXPECT_GT(switched_snapshot->version, loaded_snapshot->version);
+  ASSERT_EQ(1u, switched_snapshot->states.size());
+  EXPECT_EQ("active", switched_snapshot->states[0].state);
+}
+
+TEST_F(TestControllerManager, switch_to_fallback_controllers_on_error) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  cm->set_parameter(
+    rclcpp::Parameter(
+      "failing_controller.fallback_controllers",
+      std::vector<std::string>{test_controller::TEST_CONTROLLER_NAME}));
+
+  auto failing_controller = std::make_shared<ControllerMock>();
+  auto fallback_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(failing_controller, "failing_controller", "controller_mock");
+  cm->add_controller(
+    fallback_controller, test_controller::TEST_CONTROLLER_NAME,
+    test_controller::TEST_CONTROLLER_TYPE);
+
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"failing_controller"}, std::vector<std::string>{},
+    STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  cm->update();
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  // started in standby with the controller it backs up
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    fallback_controller->get_current_state().id());
+  EXPECT_EQ("standby", cm->get_controller_states_snapshot()->states[1].state);
+
+  EXPECT_CALL(*failing_controller, update())
+  .WillOnce(Return(controller_interface::return_type::ERROR));
+  EXPECT_EQ(controller_interface::return_type::ERROR, cm->update());
+  EXPECT_EQ(0u, fallback_controller->internal_counter) << "Standby controllers aren't updated";
+
+  // Fallback is updated right away, no switch request nor lifecycle transition involved
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(1u, fallback_controller->internal_counter);
+
+  // the failed controller is deactivated by the non-RT thread
+  executor_->add_node(cm);
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (failing_controller->get_current_state().id() !=
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE &&
+    std::chrono::steady_clock::now() < deadline)
+  {
+    executor_->spin_some();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
+    failing_controller->get_current_state().id());
+  EXPECT_EQ("active", cm->get_controller_states_snapshot()->states[1].state);
+  executor_->remove_node(cm);
+
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->update());
+  EXPECT_EQ(2u, fallback_controller->internal_counter);
+}
+
+TEST_F(TestControllerManager, demote_controller_over_budget) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  cm->set_parameter(rclcpp::Parameter("slow_controller.update_budget_us", 10.0));
+  cm->set_parameter(rclcpp::Parameter("slow_controller.budget_policy", "demote"));
+
+  auto slow_controller = std::make_shared<ControllerMock>();
+  cm->add_controller(slow_controller, "slow_controller", "controller_mock");
+
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"slow_controller"}, std::vector<std::string>{},
+    STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be blocking until next update cycle";
+  cm->update();
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  const auto snapshot_version = cm->get_controller_states_snapshot()->version;
+
+  // Each update takes way longer than the budget, so the rate is halved every time it runs
+  EXPECT_CALL(*slow_controller, update())
+  .WillRepeatedly(
+    ::testing::Invoke(
+      []() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return controller_interface::return_type::SUCCESS;
+      }));
+  for (auto i = 0u; i < 8u; ++i) {
+    cm->update();
+  }
+
+  const auto loaded_controllers = cm->get_loaded_controllers();
+  const auto & statistics = *loaded_controllers->at(0).statistics;
+  EXPECT_LT(statistics.update_count, 8u) << "Demoted controller should skip cycles";
+  EXPECT_EQ(statistics.update_count, statistics.overrun_count);
+  EXPECT_GT(statistics.update_rate_divider, 1u);
+  EXPECT_GE(statistics.max_update_ns, 1000000);
+  // the controller stays active, nothing to republish
+  executor_->add_node(cm);
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  executor_->spin_some();
+  executor_->remove_node(cm);
+  EXPECT_EQ(snapshot_version, cm->get_controller_states_snapshot()->version);
+}
+
+TEST_F(TestControllerManager, update_controllers_in_rate_group) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+
+  controller_manager::RateGroupConfig config;
+  config.name = "fast";
+  config.period = std::chrono::milliseconds(1);
+  EXPECT_EQ(controller_interface::return_type::ERROR, cm->add_rate_group(config)) <<
+    "A group without hardware would share the manager hardware with update()";
+  config.hardware = std::make_shared<test_robot_hardware::TestRobotHardware>();
+  config.hardware->init();
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->add_rate_group(config));
+  EXPECT_EQ(controller_interface::return_type::ERROR, cm->add_rate_group(config));
+  cm->set_parameter(rclcpp::Parameter("fast_controller.rate_group", "fast"));
+  cm->set_parameter(rclcpp::Parameter("lost_controller.rate_group", "unknown"));
+
+  auto default_controller = std::make_shared<test_controller::TestController>();
+  auto fast_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(
+    default_controller, "default_controller",
+    test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(fast_controller, "fast_controller", test_controller::TEST_CONTROLLER_TYPE);
+  EXPECT_EQ(
+    nullptr,
+    cm->add_controller(
+      std::make_shared<test_controller::TestController>(), "lost_controller",
+      test_controller::TEST_CONTROLLER_TYPE));
+  EXPECT_EQ(
+    controller_interface::return_type::ERROR,
+    cm->switch_controller(
+      {"fast_controller"}, {}, STRICT, true, rclcpp::Duration(0, 0))) <<
+    "Nothing would start a controller of a group that isn't running";
+  cm->start_rate_groups();
+
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"default_controller", "fast_controller"},
+    std::vector<std::string>{}, STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be waiting for the default group";
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    fast_controller->get_current_state().id()) <<
+    "The fast group should switch the modes of its own hardware without waiting for update()";
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
+    default_controller->get_current_state().id());
+  cm->update();
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    fast_controller->get_current_state().id());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  cm->update();
+  cm->stop_rate_groups();
+  EXPECT_EQ(1u, default_controller->internal_counter);
+  EXPECT_GT(fast_controller->internal_counter, 10u);
+}
+
+namespace
+{
+class ClockedRobotHardware : public test_robot_hardware::TestRobotHardware
+{
+public:
+  hardware_interface::return_type wait_for_cycle() override
+  {
+    // stands in for the bus frame, the manager must not add its own period on top of it
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ++cycle_count;
+    return hardware_interface::return_type::OK;
+  }
+
+  std::atomic<size_t> cycle_count {0};
+};
+}  // namespace
+
+TEST_F(TestControllerManager, update_rate_group_clocked_by_hardware) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  auto clocked_robot = std::make_shared<ClockedRobotHardware>();
+  clocked_robot->init();
+
+  controller_manager::RateGroupConfig config;
+  config.name = "bus";
+  config.hardware_clocked = true;
+  config.hardware = robot_;
+  EXPECT_EQ(controller_interface::return_type::ERROR, cm->add_rate_group(config)) <<
+    "The manager hardware is driven by the update() loop";
+  config.hardware = clocked_robot;
+  // much shorter than the hardware cycle, so it would run many more cycles if it were used
+  config.period = std::chrono::microseconds(100);
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->add_rate_group(config));
+  cm->set_parameter(rclcpp::Parameter("bus_controller.rate_group", "bus"));
+
+  auto bus_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(bus_controller, "bus_controller", test_controller::TEST_CONTROLLER_TYPE);
+  cm->start_rate_groups();
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"bus_controller"}, std::vector<std::string>{},
+    STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(20)));
+  cm->update();
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  cm->stop_rate_groups();
+  EXPECT_GT(bus_controller->internal_counter, 0u);
+  EXPECT_LE(bus_controller->internal_counter, clocked_robot->cycle_count.load());
+}
+
+namespace
+{
+class CountingRobotHardware : public test_robot_hardware::TestRobotHardware
+{
+public:
+  hardware_interface::return_type read() override
+  {
+    ++read_count;
+    return TestRobotHardware::read();
+  }
+
+  hardware_interface::return_type write() override
+  {
+    ++write_count;
+    return TestRobotHardware::write();
+  }
+
+  size_t read_count = 0;
+  size_t write_count = 0;
+};
+}  // namespace
+
+TEST_F(TestControllerManager, step_in_lockstep_with_simulated_time) {
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    robot_, executor_,
+    "test_controller_manager");
+  controller_manager::RateGroupConfig config;
+  config.name = "slow";
+  config.period = std::chrono::milliseconds(10);
+  auto slow_robot = std::make_shared<CountingRobotHardware>();
+  slow_robot->init();
+  config.hardware = slow_robot;
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->add_rate_group(config));
+  cm->set_parameter(rclcpp::Parameter("slow_controller.rate_group", "slow"));
+
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  auto slow_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(
+    test_controller, test_controller::TEST_CONTROLLER_NAME,
+    test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(slow_controller, "slow_controller", test_controller::TEST_CONTROLLER_TYPE);
+
+  const rclcpp::Duration period(std::chrono::milliseconds(1));
+  EXPECT_EQ(
+    controller_interface::return_type::ERROR,
+    cm->step(rclcpp::Duration(0, 0))) << "Time should go forward";
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(period));
+
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{test_controller::TEST_CONTROLLER_NAME, "slow_controller"},
+    std::vector<std::string>{}, STRICT, true, rclcpp::Duration(0, 0));
+  ASSERT_EQ(
+    std::future_status::timeout,
+    switch_future.wait_for(std::chrono::milliseconds(100))) <<
+    "switch_controller should be waiting for a step";
+  // the slow group stops its controllers, switches the modes of its hardware and starts them
+  // on its next cycle, 10 ms of simulated time later
+  for (auto i = 0u; i < 9u; ++i) {
+    EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(period));
+  }
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    slow_controller->get_current_state().id());
+
+  const auto counter = test_controller->internal_counter;
+  const auto slow_counter = slow_controller->internal_counter;
+  const auto slow_reads = slow_robot->read_count;
+  const auto slow_writes = slow_robot->write_count;
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(period, 100));
+  EXPECT_EQ(counter + 100u, test_controller->internal_counter);
+  EXPECT_EQ(slow_counter + 10u, slow_controller->internal_counter);
+  EXPECT_EQ(slow_reads + 10u, slow_robot->read_count) <<
+    "The hardware of a group should only be read on the steps the group updates";
+  EXPECT_EQ(slow_writes + 10u, slow_robot->write_count);
+
+  EXPECT_EQ(rclcpp::Time(0, 110000000, RCL_ROS_TIME), cm->get_simulated_time());
+  EXPECT_EQ(cm->get_simulated_time(), test_controller->get_update_time());
+  EXPECT_EQ(period, test_controller->get_update_period());
+  EXPECT_EQ(rclcpp::Duration(std::chrono::milliseconds(10)), slow_controller->get_update_period());
+  EXPECT_GT(cm->get_step_cycles_per_second(), 0.0);
+
+  controller_manager::RateGroupConfig late_config;
+  late_config.name = "late";
+  late_config.hardware = std::make_shared<test_robot_hardware::TestRobotHardware>();
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->add_rate_group(late_config));
+  cm->start_rate_groups();
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->step(period)) <<
+    "Rate groups should not start once stepping";
+}
+
+namespace
+{
+class ModeSwitchingRobotHardware : public test_robot_hardware::TestRobotHardware
+{
+public:
+  hardware_interface::return_type prepare_mode_switch(
+    const hardware_interface::ControllerSwitch & controller_switch) override
+  {
+    prepared_switches.push_back(controller_switch);
+    return accept_switch ?
+           hardware_interface::return_type::OK : hardware_interface::return_type::ERROR;
+  }
+
+  hardware_interface::return_type perform_mode_switch(
+    const hardware_interface::ControllerSwitch & controller_switch) override
+  {
+    performed_switches.push_back(controller_switch);
+    if (on_perform_mode_switch) {
+      on_perform_mode_switch();
+    }
+    return perform_switch ?
+           hardware_interface::return_type::OK : hardware_interface::return_type::ERROR;
+  }
+
+  bool accept_switch = true;
+  bool perform_switch = true;
+  std::vector<hardware_interface::ControllerSwitch> prepared_switches;
+  std::vector<hardware_interface::ControllerSwitch> performed_switches;
+  std::function<void()> on_perform_mode_switch;
+};
+}  // namespace
+
+TEST_F(TestControllerManager, switch_hardware_modes_in_one_batch) {
+  auto mode_robot = std::make_shared<ModeSwitchingRobotHardware>();
+  mode_robot->init();
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    mode_robot, executor_,
+    "test_controller_manager");
+  cm->set_parameter(
+    rclcpp::Parameter(
+      "effort_controller.claimed_interfaces",
+      std::vector<std::string>{"joint1/effort_command", "joint2/effort_command"}));
+
+  auto effort_controller = std::make_shared<test_controller::TestController>();
+  auto other_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(
+    effort_controller, "effort_controller",
+    test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(other_controller, "other_controller", test_controller::TEST_CONTROLLER_TYPE);
+
+  auto switch_controller = [&cm](const std::vector<std::string> & start_controllers) {
+      auto switch_future = std::async(
+        std::launch::async,
+        &controller_manager::ControllerManager::switch_controller, cm,
+        start_controllers, std::vector<std::string>{}, STRICT, true, rclcpp::Duration(0, 0));
+      while (switch_future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+        cm->update();
+      }
+      return switch_future.get();
+    };
+
+  // both controllers switched with a single transaction
+  EXPECT_EQ(
+    controller_interface::return_type::SUCCESS,
+    switch_controller({"effort_controller", "other_controller"}));
+  ASSERT_EQ(1u, mode_robot->prepared_switches.size());
+  ASSERT_EQ(1u, mode_robot->performed_switches.size());
+  const auto & performed = mode_robot->performed_switches[0];
+  ASSERT_EQ(2u, performed.start_controllers.size());
+  EXPECT_TRUE(performed.stop_controllers.empty());
+  EXPECT_EQ("effort_controller", performed.start_controllers[0].name);
+  EXPECT_EQ(
+    (std::vector<std::string>{"joint1/effort_command", "joint2/effort_command"}),
+    performed.start_controllers[0].claimed_interfaces);
+
+  // refused by the hardware, nothing happens
+  mode_robot->accept_switch = false;
+  auto stop_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{}, std::vector<std::string>{"effort_controller"}, STRICT, true,
+    rclcpp::Duration(0, 0));
+  EXPECT_EQ(controller_interface::return_type::ERROR, stop_future.get());
+  EXPECT_EQ(1u, mode_robot->performed_switches.size());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    effort_controller->get_current_state().id());
+
+  // failed on the hardware, the controllers to stop are stopped but none is started
+  mode_robot->accept_switch = true;
+  mode_robot->perform_switch = false;
+  uint8_t state_at_mode_switch = lifecycle_msgs::msg::State::PRIMARY_STATE_UNKNOWN;
+  mode_robot->on_perform_mode_switch = [&]() {
+      state_at_mode_switch = effort_controller->get_current_state().id();
+    };
+  auto failed_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{}, std::vector<std::string>{"effort_controller"}, STRICT, true,
+    rclcpp::Duration(0, 0));
+  while (failed_future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+    cm->update();
+  }
+  EXPECT_EQ(controller_interface::return_type::ERROR, failed_future.get());
+  EXPECT_EQ(2u, mode_robot->performed_switches.size());
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
+    effort_controller->get_current_state().id());
+  EXPECT_EQ(lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE, state_at_mode_switch) <<
+    "Controllers should stop before the hardware switches modes";
+  mode_robot->on_perform_mode_switch = nullptr;
+  mode_robot->perform_switch = true;
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_controller({"effort_controller"}));
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    effort_controller->get_current_state().id());
+}
+
+TEST_F(TestControllerManager, switch_modes_of_the_hardware_of_each_group) {
+  auto mode_robot = std::make_shared<ModeSwitchingRobotHardware>();
+  mode_robot->init();
+  auto group_robot = std::make_shared<ModeSwitchingRobotHardware>();
+  group_robot->init();
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+    mode_robot, executor_,
+    "test_controller_manager");
+  controller_manager::RateGroupConfig config;
+  config.name = "bus";
+  config.hardware = group_robot;
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm->add_rate_group(config));
+  cm->set_parameter(rclcpp::Parameter("bus_controller.rate_group", "bus"));
+
+  auto default_controller = std::make_shared<test_controller::TestController>();
+  auto bus_controller = std::make_shared<test_controller::TestController>();
+  cm->add_controller(
+    default_controller, "default_controller",
+    test_controller::TEST_CONTROLLER_TYPE);
+  cm->add_controller(bus_controller, "bus_controller", test_controller::TEST_CONTROLLER_TYPE);
+  cm->start_rate_groups();
+
+  auto switch_future = std::async(
+    std::launch::async,
+    &controller_manager::ControllerManager::switch_controller, cm,
+    std::vector<std::string>{"default_controller", "bus_controller"},
+    std::vector<std::string>{}, STRICT, true, rclcpp::Duration(0, 0));
+  while (switch_future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+    cm->update();
+  }
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, switch_future.get());
+  cm->stop_rate_groups();
+
+  // each hardware only switches the modes for the controllers of the groups it belongs to
+  ASSERT_EQ(1u, mode_robot->performed_switches.size());
+  ASSERT_EQ(1u, mode_robot->performed_switches[0].start_controllers.size());
+  EXPECT_EQ("default_controller", mode_robot->performed_switches[0].start_controllers[0].name);
+  ASSERT_EQ(1u, group_robot->performed_switches.size());
+  ASSERT_EQ(1u, group_robot->performed_switches[0].start_controllers.size());
+  EXPECT_EQ("bus_controller", group_robot->performed_switches[0].start_controllers[0].name);
+}
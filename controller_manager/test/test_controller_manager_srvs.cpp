@@ -21,6 +21,8 @@
 #include "controller_manager_test_common.hpp"
 #include "controller_interface/controller_interface.hpp"
 #include "controller_manager/controller_manager.hpp"
+#include "controller_manager_msgs/msg/controller_event.hpp"
+#include "controller_manager_msgs/msg/controller_states.hpp"
 #include "controller_manager_msgs/srv/switch_controller.hpp"
 #include "controller_manager_msgs/srv/list_controller_types.hpp"
 #include "controller_manager_msgs/srv/list_controllers.hpp"
@@ -120,6 +122,34 @@ TEST_F(TestControllerManagerSrvs, list_controller_types)
     ::testing::Contains("controller_interface::ControllerInterface"));
 }
 
+TEST_F(TestControllerManagerSrvs, list_controller_types_by_package)
+{
+  rclcpp::executors::SingleThreadedExecutor srv_executor;
+  rclcpp::Node::SharedPtr srv_node = std::make_shared<rclcpp::Node>("srv_client");
+  srv_executor.add_node(srv_node);
+  rclcpp::Client<controller_manager_msgs::srv::ListControllerTypes>::SharedPtr client =
+    srv_node->create_client<controller_manager_msgs::srv::ListControllerTypes>(
+    "test_controller_manager/list_controller_types");
+  auto request = std::make_shared<controller_manager_msgs::srv::ListControllerTypes::Request>();
+
+  request->package = "controller_manager";
+  auto result = call_service_and_wait(*client, request, srv_executor);
+  ASSERT_THAT(result->types, ::testing::Contains("test_controller"));
+  ASSERT_EQ(result->types.size(), result->base_classes.size());
+
+  request->package = "nonexistent_package";
+  result = call_service_and_wait(*client, request, srv_executor);
+  ASSERT_EQ(0u, result->types.size());
+
+  const auto catalogue = cm_->get_controller_type_catalogue();
+  const auto type_it = catalogue->index_by_type.find("test_controller");
+  ASSERT_NE(catalogue->index_by_type.end(), type_it);
+  const auto & info = catalogue->types[type_it->second];
+  EXPECT_EQ("controller_manager", info.package);
+  EXPECT_EQ("controller_interface::ControllerInterface", info.base_class);
+  EXPECT_FALSE(info.library_path.empty());
+}
+
 TEST_F(TestControllerManagerSrvs, list_controllers_srv) {
   rclcpp::executors::SingleThreadedExecutor srv_executor;
   rclcpp::Node::SharedPtr srv_node = std::make_shared<rclcpp::Node>("srv_client");
@@ -138,7 +168,7 @@ TEST_F(TestControllerManagerSrvs, list_controllers_srv) {
   auto abstract_test_controller = cm_->add_controller(
     test_controller, test_controller::TEST_CONTROLLER_NAME,
     test_controller::TEST_CONTROLLER_TYPE);
-  EXPECT_EQ(1u, cm_->get_loaded_controllers().size());
+  EXPECT_EQ(1u, cm_->get_loaded_controllers()->size());
   result = call_service_and_wait(*client, request, srv_executor);
   ASSERT_EQ(
     1u,
@@ -255,6 +285,52 @@ TEST_F(TestControllerManagerSrvs, reload_controller_libraries_srv) {
     "Controller should have been stopped and cleaned up with force_kill = true";
 }
 
+TEST_F(TestControllerManagerSrvs, reload_selected_controller_libraries_srv) {
+  rclcpp::executors::SingleThreadedExecutor srv_executor;
+  rclcpp::Node::SharedPtr srv_node = std::make_shared<rclcpp::Node>("srv_client");
+  srv_executor.add_node(srv_node);
+  rclcpp::Client<controller_manager_msgs::srv::ReloadControllerLibraries>::SharedPtr client =
+    srv_node->create_client<controller_manager_msgs::srv::ReloadControllerLibraries>(
+    "test_controller_manager/reload_controller_libraries");
+  auto request =
+    std::make_shared<controller_manager_msgs::srv::ReloadControllerLibraries::Request>();
+  request->controller_types = {test_controller::TEST_CONTROLLER_TYPE};
+
+  // A controller of another type keeps running during the reload
+  auto other_controller = std::make_shared<test_controller::TestController>();
+  cm_->add_controller(other_controller, "other_controller", "other_controller_type");
+
+  auto test_controller = cm_->load_controller(
+    test_controller::TEST_CONTROLLER_NAME,
+    test_controller::TEST_CONTROLLER_TYPE);
+  cm_->switch_controller(
+    {test_controller::TEST_CONTROLLER_NAME, "other_controller"}, {},
+    controller_manager_msgs::srv::SwitchController::Request::STRICT, true,
+    rclcpp::Duration(0, 0));
+
+  request->force_kill = false;
+  auto result = call_service_and_wait(*client, request, srv_executor);
+  ASSERT_FALSE(result->ok) << "Cannot reload if controllers of these types are running";
+
+  request->force_kill = true;
+  result = call_service_and_wait(*client, request, srv_executor, true);
+  ASSERT_TRUE(result->ok);
+
+  ASSERT_EQ(
+    test_controller.use_count(),
+    1) << "The controller should have been replaced by a new instance";
+  const auto loaded_controllers = cm_->get_loaded_controllers();
+  ASSERT_EQ(2u, loaded_controllers->size());
+  for (const auto & controller : *loaded_controllers) {
+    EXPECT_EQ(
+      lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+      controller.c->get_current_state().id()) << controller.info.name << " should be running";
+  }
+  EXPECT_EQ(
+    lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE,
+    other_controller->get_current_state().id());
+}
+
 TEST_F(TestControllerManagerSrvs, load_controller_srv) {
   rclcpp::executors::SingleThreadedExecutor srv_executor;
   rclcpp::Node::SharedPtr srv_node = std::make_shared<rclcpp::Node>("srv_client");
@@ -291,9 +367,56 @@ TEST_F(TestControllerManagerSrvs, unload_controller_srv) {
   auto abstract_test_controller = cm_->add_controller(
     test_controller, test_controller::TEST_CONTROLLER_NAME,
     test_controller::TEST_CONTROLLER_TYPE);
-  EXPECT_EQ(1u, cm_->get_loaded_controllers().size());
+  EXPECT_EQ(1u, cm_->get_loaded_controllers()->size());
 
   result = call_service_and_wait(*client, request, srv_executor, true);
   ASSERT_TRUE(result->ok);
-  EXPECT_EQ(0u, cm_->get_loaded_controllers().size());
+  EXPECT_EQ(0u, cm_->get_loaded_controllers()->size());
+}
+
+TEST_F(TestControllerManagerSrvs, controller_states_and_events_topics) {
+  using controller_manager_msgs::msg::ControllerEvent;
+  using controller_manager_msgs::msg::ControllerStates;
+
+  rclcpp::executors::SingleThreadedExecutor sub_executor;
+  rclcpp::Node::SharedPtr sub_node = std::make_shared<rclcpp::Node>("sub_node");
+  sub_executor.add_node(sub_node);
+
+  std::vector<ControllerEvent> events;
+  ControllerStates last_states;
+  auto events_sub = sub_node->create_subscription<ControllerEvent>(
+    "test_controller_manager/controller_events", rclcpp::QoS(100),
+    [&events](const ControllerEvent::SharedPtr msg) {events.push_back(*msg);});
+  auto states_sub = sub_node->create_subscription<ControllerStates>(
+    "test_controller_manager/controller_states", rclcpp::QoS(1).transient_local(),
+    [&last_states](const ControllerStates::SharedPtr msg) {last_states = *msg;});
+  // Let discovery happen before anything is published
+  sub_executor.spin_some(100ms);
+
+  auto test_controller = std::make_shared<test_controller::TestController>();
+  cm_->add_controller(
+    test_controller, test_controller::TEST_CONTROLLER_NAME,
+    test_controller::TEST_CONTROLLER_TYPE);
+  cm_->switch_controller(
+    {test_controller::TEST_CONTROLLER_NAME}, {},
+    controller_manager_msgs::srv::SwitchController::Request::STRICT, true,
+    rclcpp::Duration(0, 0));
+
+  const auto deadline = std::chrono::steady_clock::now() + 1s;
+  while (events.size() < 3u && std::chrono::steady_clock::now() < deadline) {
+    sub_executor.spin_some(10ms);
+  }
+
+  ASSERT_EQ(3u, events.size());
+  EXPECT_EQ(ControllerEvent::LOADED, events[0].transition);
+  EXPECT_EQ(ControllerEvent::CONFIGURED, events[1].transition);
+  EXPECT_EQ(ControllerEvent::ACTIVE, events[2].transition);
+  for (size_t i = 1; i < events.size(); ++i) {
+    EXPECT_EQ(events[i - 1].sequence_number + 1, events[i].sequence_number);
+    EXPECT_EQ(test_controller::TEST_CONTROLLER_NAME, events[i].name);
+  }
+
+  ASSERT_EQ(1u, last_states.controller.size());
+  EXPECT_EQ("active", last_states.controller[0].state);
+  EXPECT_EQ(events.back().version, last_states.version);
 }
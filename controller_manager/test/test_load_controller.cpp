@@ -42,10 +42,10 @@ TEST_F(TestControllerManager, load1_known_controller)
 {
   controller_manager::ControllerManager cm(robot_, executor_, "test_controller_manager");
   ASSERT_NO_THROW(cm.load_controller("test_controller_01", test_controller::TEST_CONTROLLER_TYPE));
-  EXPECT_EQ(1u, cm.get_loaded_controllers().size());
+  EXPECT_EQ(1u, cm.get_loaded_controllers()->size());
 
   controller_manager::ControllerSpec abstract_test_controller =
-    cm.get_loaded_controllers()[0];
+    cm.get_loaded_controllers()->at(0);
 
   auto lifecycle_node = abstract_test_controller.c->get_lifecycle_node();
   lifecycle_node->configure();
@@ -62,9 +62,9 @@ TEST_F(TestControllerManager, load2_known_controller)
   // load the controller with name1
   std::string controller_name1 = "test_controller1";
   ASSERT_NO_THROW(cm.load_controller(controller_name1, controller_type));
-  EXPECT_EQ(1u, cm.get_loaded_controllers().size());
+  EXPECT_EQ(1u, cm.get_loaded_controllers()->size());
   controller_manager::ControllerSpec abstract_test_controller1 =
-    cm.get_loaded_controllers()[0];
+    cm.get_loaded_controllers()->at(0);
   EXPECT_STREQ(
     controller_name1.c_str(), abstract_test_controller1.c->get_lifecycle_node()->get_name());
   abstract_test_controller1.c->get_lifecycle_node()->configure();
@@ -75,9 +75,9 @@ TEST_F(TestControllerManager, load2_known_controller)
   // load the same controller again with a different name
   std::string controller_name2 = "test_controller2";
   ASSERT_NO_THROW(cm.load_controller(controller_name2, controller_type));
-  EXPECT_EQ(2u, cm.get_loaded_controllers().size());
+  EXPECT_EQ(2u, cm.get_loaded_controllers()->size());
   controller_manager::ControllerSpec abstract_test_controller2 =
-    cm.get_loaded_controllers()[1];
+    cm.get_loaded_controllers()->at(1);
   EXPECT_STREQ(
     controller_name2.c_str(), abstract_test_controller2.c->get_lifecycle_node()->get_name());
   EXPECT_STREQ(
@@ -94,7 +94,7 @@ TEST_F(TestControllerManager, update)
   ASSERT_NO_THROW(cm.load_controller("test_controller_01", test_controller::TEST_CONTROLLER_TYPE));
 
   controller_manager::ControllerSpec abstract_test_controller =
-    cm.get_loaded_controllers()[0];
+    cm.get_loaded_controllers()->at(0);
 
   auto lifecycle_node = abstract_test_controller.c->get_lifecycle_node();
   lifecycle_node->configure();
@@ -113,7 +113,7 @@ TEST_F(TestControllerManager, switch_controller_empty)
   // load the controller with name1
   std::string controller_name1 = "test_controller1";
   ASSERT_NO_THROW(cm->load_controller(controller_name1, controller_type));
-  EXPECT_EQ(1u, cm->get_loaded_controllers().size());
+  EXPECT_EQ(1u, cm->get_loaded_controllers()->size());
 
   const auto UNSPECIFIED = 0;
 
@@ -210,9 +210,9 @@ TEST_F(TestControllerManager, switch_controller)
   // load the controller with name1
   std::string controller_name1 = "test_controller1";
   ASSERT_NO_THROW(cm->load_controller(controller_name1, controller_type));
-  EXPECT_EQ(1u, cm->get_loaded_controllers().size());
+  EXPECT_EQ(1u, cm->get_loaded_controllers()->size());
   controller_manager::ControllerSpec abstract_test_controller1 =
-    cm->get_loaded_controllers()[0];
+    cm->get_loaded_controllers()->at(0);
 
   ASSERT_EQ(
     lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
@@ -327,11 +327,11 @@ TEST_F(TestControllerManager, switch_multiple_controllers)
   std::string controller_name2 = "test_controller2";
   ASSERT_NO_THROW(cm->load_controller(controller_name1, controller_type));
   ASSERT_NO_THROW(cm->load_controller(controller_name2, controller_type));
-  EXPECT_EQ(2u, cm->get_loaded_controllers().size());
+  EXPECT_EQ(2u, cm->get_loaded_controllers()->size());
   controller_manager::ControllerSpec abstract_test_controller1 =
-    cm->get_loaded_controllers()[0];
+    cm->get_loaded_controllers()->at(0);
   controller_manager::ControllerSpec abstract_test_controller2 =
-    cm->get_loaded_controllers()[1];
+    cm->get_loaded_controllers()->at(1);
 
   ASSERT_EQ(
     lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE,
@@ -426,3 +426,23 @@ TEST_F(TestControllerManager, switch_multiple_controllers)
       abstract_test_controller2.c->get_lifecycle_node()->get_current_state().id());
   }
 }
+
+TEST_F(TestControllerManager, load_controllers_in_executor_groups)
+{
+  controller_manager::ControllerManager cm(robot_, executor_, "test_controller_manager");
+  cm.set_parameter(rclcpp::Parameter("use_static_executors", true));
+  cm.set_parameter(rclcpp::Parameter("test_controller1.executor_group", "fast"));
+  cm.set_parameter(rclcpp::Parameter("test_controller2.executor_group", "fast"));
+  std::string controller_type = test_controller::TEST_CONTROLLER_TYPE;
+
+  ASSERT_NO_THROW(cm.load_controller("test_controller1", controller_type));
+  ASSERT_NO_THROW(cm.load_controller("test_controller2", controller_type));
+  ASSERT_NO_THROW(cm.load_controller("test_controller3", controller_type));
+  EXPECT_EQ(3u, cm.get_loaded_controllers()->size());
+
+  // Controllers are unloaded from the executor of their group, the last one stops its thread
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm.unload_controller("test_controller1"));
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm.unload_controller("test_controller2"));
+  EXPECT_EQ(controller_interface::return_type::SUCCESS, cm.unload_controller("test_controller3"));
+  EXPECT_EQ(0u, cm.get_loaded_controllers()->size());
+}
@@ -0,0 +1,66 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "controller_manager/perf_counters.hpp"
+
+using controller_manager::PerfCounter;
+using controller_manager::PerfCounters;
+using controller_manager::PerfSample;
+
+TEST(TestPerfCounters, closed_counters_read_nothing) {
+  PerfCounters counters;
+  PerfSample sample;
+  sample.fill(1);
+  EXPECT_FALSE(counters.is_open());
+  EXPECT_FALSE(counters.read(sample));
+  EXPECT_EQ(0u, sample[static_cast<size_t>(PerfCounter::PAGE_FAULTS)]);
+}
+
+TEST(TestPerfCounters, count_the_calling_thread) {
+  PerfCounters counters;
+  std::string error;
+  if (!counters.open(error)) {
+    // e.g. not on Linux or perf_event_paranoid forbids it
+    EXPECT_FALSE(error.empty());
+    return;
+  }
+  PerfSample before, after;
+  ASSERT_TRUE(counters.read(before));
+  // touch fresh pages, at least some of them fault
+  std::vector<char> pages(64 * 4096);
+  for (size_t i = 0; i < pages.size(); i += 4096) {
+    pages[i] = 1;
+  }
+  ASSERT_TRUE(counters.read(after));
+  for (size_t i = 0; i < before.size(); ++i) {
+    EXPECT_GE(after[i], before[i]);
+  }
+  if (counters.has(PerfCounter::PAGE_FAULTS)) {
+    EXPECT_GT(
+      after[static_cast<size_t>(PerfCounter::PAGE_FAULTS)],
+      before[static_cast<size_t>(PerfCounter::PAGE_FAULTS)]);
+  }
+  if (!counters.has(PerfCounter::INSTRUCTIONS)) {
+    EXPECT_EQ(0u, after[static_cast<size_t>(PerfCounter::INSTRUCTIONS)]);
+  }
+
+  counters.close();
+  EXPECT_FALSE(counters.is_open());
+  EXPECT_FALSE(counters.read(after));
+}
@@ -0,0 +1,61 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <thread>
+
+#include "controller_manager/triple_buffer.hpp"
+
+TEST(TestTripleBuffer, read_last_published_value) {
+  controller_manager::TripleBuffer<int> buffer(-1);
+  EXPECT_FALSE(buffer.update());
+  EXPECT_EQ(-1, buffer.read_buffer());
+
+  buffer.write(1);
+  buffer.write(2);
+  EXPECT_TRUE(buffer.update());
+  EXPECT_EQ(2, buffer.read_buffer());
+  EXPECT_FALSE(buffer.update());
+  EXPECT_EQ(2, buffer.read());
+
+  buffer.write_buffer() = 3;
+  EXPECT_EQ(2, buffer.read()) << "Not published yet";
+  buffer.publish();
+  EXPECT_EQ(3, buffer.read());
+}
+
+TEST(TestTripleBuffer, reader_never_sees_partial_writes) {
+  controller_manager::TripleBuffer<std::array<int, 64>> buffer;
+  constexpr int iterations = 100000;
+
+  std::thread writer([&buffer]() {
+      for (int i = 1; i <= iterations; ++i) {
+        buffer.write_buffer().fill(i);
+        buffer.publish();
+      }
+    });
+
+  int last_value = 0;
+  while (last_value < iterations) {
+    const auto & values = buffer.read();
+    for (const auto value : values) {
+      ASSERT_EQ(values[0], value);
+    }
+    ASSERT_GE(values[0], last_value) << "Values should never go back in time";
+    last_value = values[0];
+  }
+  writer.join();
+}
@@ -0,0 +1,76 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__COMMAND_WATCHDOG_HPP_
+#define HARDWARE_INTERFACE__COMMAND_WATCHDOG_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "hardware_interface/types/write_sequence.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+
+/** \brief Replaces the commands nobody wrote for a while by safe values
+ *
+ * Runs in the control loop right before the hardware is written, so a controller that stopped
+ * updating can't leave the hardware executing its last command and no watchdog thread is needed.
+ * Freshness is told by the write sequence of the commands, the watched commands are kept in flat
+ * arrays and all checked in one pass per cycle.
+ */
+class CommandWatchdog
+{
+public:
+  /**
+   * \brief Watch a command
+   * \param value the command value, set to \p safe_value while it is stale
+   * \param write_sequence incremented on each write of the command
+   * \param max_stale_cycles number of enforce() calls the command may be left unwritten
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void watch(
+    double * value, const WriteSequence * write_sequence, double safe_value,
+    std::uint32_t max_stale_cycles);
+
+  HARDWARE_INTERFACE_PUBLIC
+  void clear();
+
+  HARDWARE_INTERFACE_PUBLIC
+  size_t size() const;
+
+  /**
+   * \brief Set the commands not written for more than their max stale cycles to their safe value
+   * \return the number of stale commands
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  size_t enforce();
+
+private:
+  std::vector<double *> values_;
+  std::vector<const WriteSequence *> write_sequences_;
+  std::vector<double> safe_values_;
+  // as wide as the sequences, so the checks vectorize without conversions
+  std::vector<std::uint64_t> max_stale_cycles_;
+  std::vector<std::uint64_t> stale_cycles_;
+  std::vector<std::uint64_t> last_sequences_;
+  // gathered from write_sequences_ each cycle, so the checks run on contiguous values
+  std::vector<std::uint64_t> sequences_;
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__COMMAND_WATCHDOG_HPP_
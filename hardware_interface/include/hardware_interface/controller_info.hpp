@@ -16,8 +16,8 @@
 #define HARDWARE_INTERFACE__CONTROLLER_INFO_HPP_
 
 #include <string>
+#include <vector>
 // TODO(v-lopez)
-// #include <vector>
 // #include <hardware_interface/interface_resources.h>
 
 namespace hardware_interface
@@ -36,10 +36,29 @@ struct ControllerInfo
   /** Controller type. */
   std::string type;
 
+  /** Controllers to start in place of this one if its update fails. */
+  std::vector<std::string> fallback_controllers;
+
+  /** Interfaces the controller commands, as `<joint or actuator>/<interface>`. */
+  std::vector<std::string> claimed_interfaces;
+
   // TODO(v-lopez)
   /** Claimed resources, grouped by the hardware interface they belong to. */
 //   std::map<std::string, std::vector<std::string>> resources;
 };
 
+/** \brief Controllers started and stopped together by a switch
+ *
+ * Lets the hardware change the modes of all the interfaces they claim in a single transaction.
+ */
+struct ControllerSwitch
+{
+  /** Controllers starting, that weren't running. */
+  std::vector<ControllerInfo> start_controllers;
+
+  /** Controllers stopping, that won't run anymore. */
+  std::vector<ControllerInfo> stop_controllers;
+};
+
 }  // namespace hardware_interface
 #endif  // HARDWARE_INTERFACE__CONTROLLER_INFO_HPP_
@@ -15,10 +15,13 @@
 #ifndef HARDWARE_INTERFACE__HANDLE_HPP_
 #define HARDWARE_INTERFACE__HANDLE_HPP_
 
+#include <cstdint>
 #include <string>
 #include <utility>
 
 #include "hardware_interface/macros.hpp"
+#include "hardware_interface/types/interface_sample.hpp"
+#include "hardware_interface/types/write_sequence.hpp"
 #include "hardware_interface/visibility_control.h"
 
 namespace hardware_interface
@@ -31,18 +34,23 @@ public:
   ReadOnlyHandle(
     const std::string & name,
     const std::string & interface_name,
-    double * value_ptr = nullptr)
-  : name_(name), interface_name_(interface_name), value_ptr_(value_ptr)
+    double * value_ptr = nullptr,
+    WriteSequence * write_sequence_ptr = nullptr,
+    InterfaceSample * sample_ptr = nullptr)
+  : name_(name), interface_name_(interface_name), value_ptr_(value_ptr),
+    write_sequence_ptr_(write_sequence_ptr), sample_ptr_(sample_ptr)
   {
   }
 
   explicit ReadOnlyHandle(const std::string & interface_name)
-  : interface_name_(interface_name), value_ptr_(nullptr)
+  : interface_name_(interface_name), value_ptr_(nullptr), write_sequence_ptr_(nullptr),
+    sample_ptr_(nullptr)
   {
   }
 
   explicit ReadOnlyHandle(const char * interface_name)
-  : interface_name_(interface_name), value_ptr_(nullptr)
+  : interface_name_(interface_name), value_ptr_(nullptr), write_sequence_ptr_(nullptr),
+    sample_ptr_(nullptr)
   {
   }
 
@@ -59,9 +67,11 @@ public:
   /// \brief returns true if handle references a value
   inline operator bool() const {return value_ptr_ != nullptr;}
 
-  HandleType with_value_ptr(double * value_ptr)
+  HandleType with_value_ptr(
+    double * value_ptr, WriteSequence * write_sequence_ptr = nullptr,
+    InterfaceSample * sample_ptr = nullptr)
   {
-    return HandleType(name_, interface_name_, value_ptr);
+    return HandleType(name_, interface_name_, value_ptr, write_sequence_ptr, sample_ptr);
   }
 
   const std::string & get_name() const
@@ -80,10 +90,38 @@ public:
     return *value_ptr_;
   }
 
+  /// \brief returns true if writes to the value are counted
+  bool has_write_sequence() const
+  {
+    return write_sequence_ptr_ != nullptr;
+  }
+
+  /// \brief returns the number of set_value() calls on the value through any of its handles
+  std::uint64_t get_write_sequence() const
+  {
+    THROW_ON_NULLPTR(write_sequence_ptr_);
+    return write_sequence_ptr_->load();
+  }
+
+  /// \brief returns true if the handle references the sample time and validity of the value
+  bool has_sample() const
+  {
+    return sample_ptr_ != nullptr;
+  }
+
+  /// \brief returns when the value was sampled by the hardware, and whether it is valid
+  const InterfaceSample & get_sample() const
+  {
+    THROW_ON_NULLPTR(sample_ptr_);
+    return *sample_ptr_;
+  }
+
 protected:
   std::string name_;
   std::string interface_name_;
   double * value_ptr_;
+  WriteSequence * write_sequence_ptr_;
+  InterfaceSample * sample_ptr_;
 };
 
 template<class HandleType>
@@ -93,8 +131,10 @@ public:
   ReadWriteHandle(
     const std::string & name,
     const std::string & interface_name,
-    double * value_ptr = nullptr)
-  : ReadOnlyHandle<HandleType>(name, interface_name, value_ptr)
+    double * value_ptr = nullptr,
+    WriteSequence * write_sequence_ptr = nullptr,
+    InterfaceSample * sample_ptr = nullptr)
+  : ReadOnlyHandle<HandleType>(name, interface_name, value_ptr, write_sequence_ptr, sample_ptr)
   {}
 
   explicit ReadWriteHandle(const std::string & interface_name)
@@ -119,6 +159,7 @@ public:
   {
     THROW_ON_NULLPTR(this->value_ptr_);
     *this->value_ptr_ = value;
+    count_write();
   }
 
   void set_value(const std::string & name, double value)
@@ -126,6 +167,7 @@ public:
     THROW_ON_NULLPTR(this->value_ptr_);
     this->name_ = name;
     *this->value_ptr_ = value;
+    count_write();
   }
 
   void set_value(const char * name, double value)
@@ -133,6 +175,24 @@ public:
     THROW_ON_NULLPTR(this->value_ptr_);
     this->name_ = name;
     *this->value_ptr_ = value;
+    count_write();
+  }
+
+  /// \brief stamps the value with the time it was sampled at, for the hardware to call on read
+  void set_sample(rcutils_time_point_value_t time, bool valid = true)
+  {
+    THROW_ON_NULLPTR(this->sample_ptr_);
+    this->sample_ptr_->time = time;
+    this->sample_ptr_->valid = valid;
+  }
+
+private:
+  // lets the hardware tell a fresh command from one left by a controller that stopped updating
+  inline void count_write()
+  {
+    if (this->write_sequence_ptr_) {
+      this->write_sequence_ptr_->increment();
+    }
   }
 };
 
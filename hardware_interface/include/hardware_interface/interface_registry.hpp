@@ -0,0 +1,239 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__INTERFACE_REGISTRY_HPP_
+#define HARDWARE_INTERFACE__INTERFACE_REGISTRY_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/types/interface_sample.hpp"
+#include "hardware_interface/types/write_sequence.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+/** Kind of component an interface belongs to, names only need to be unique in a namespace. */
+enum class InterfaceNamespace : std::uint8_t
+{
+  ACTUATOR,
+  JOINT,
+  SENSOR,
+  GPIO,
+};
+
+/** An interface of a component to register, with its initial value. */
+struct InterfaceRegistration
+{
+  std::string name;
+  std::string interface_name;
+  double default_value = 0.0;
+};
+
+/** \brief Storage of the double interfaces of all components of a robot hardware
+ *
+ * The values of all namespaces are stored back to back in registration order, along with their
+ * write sequences and samples, so the whole state can be copied at once through data().
+ * Interfaces are looked up through a single hash index. Registering interfaces may move the
+ * values, so handing out the first handle freezes the registration, see freeze().
+ */
+class InterfaceRegistry
+{
+public:
+  /// Returned by find() for interfaces that aren't registered
+  static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+  HARDWARE_INTERFACE_PUBLIC
+  return_type register_interface(
+    InterfaceNamespace ns, const std::string & name, const std::string & interface_name,
+    double default_value = 0.0);
+
+  /// Register a whole table of interfaces, or none of them if one is empty or already registered.
+  HARDWARE_INTERFACE_PUBLIC
+  return_type register_interfaces(
+    InterfaceNamespace ns, const std::vector<InterfaceRegistration> & interfaces);
+
+  /// Refuse any further registration, so the handles taken stay valid as long as the registry.
+  HARDWARE_INTERFACE_PUBLIC
+  void freeze();
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_frozen() const;
+
+  /// Index of the value of an interface in data(), npos if it isn't registered.
+  HARDWARE_INTERFACE_PUBLIC
+  size_t find(
+    InterfaceNamespace ns, const std::string & name, const std::string & interface_name) const;
+
+  /// Index of the value of an interface in data(), logging an error if it isn't registered.
+  HARDWARE_INTERFACE_PUBLIC
+  return_type find_interface(
+    InterfaceNamespace ns, const std::string & name, const std::string & interface_name,
+    size_t & index) const;
+
+  /// Bind \p handle to the interface of the same name in \p ns, freezing the registration.
+  template<class HandleType>
+  return_type get_handle(InterfaceNamespace ns, HandleType & handle)
+  {
+    size_t index = 0;
+    if (find_interface(ns, handle.get_name(), handle.get_interface_name(), index) !=
+      return_type::OK)
+    {
+      return return_type::ERROR;
+    }
+    freeze();
+    handle = handle.with_value_ptr(&values_[index], &write_sequences_[index], &samples_[index]);
+    return return_type::OK;
+  }
+
+  /// Handles of all interfaces of \p ns, component by component, freezing the registration.
+  template<class HandleType>
+  std::vector<HandleType> get_handles(InterfaceNamespace ns)
+  {
+    freeze();
+    std::vector<HandleType> handles;
+    const auto & components = namespaces_[static_cast<size_t>(ns)].components;
+    for (const auto & component : components) {
+      for (size_t i = 0; i < component.indices.size(); ++i) {
+        const size_t index = component.indices[i];
+        handles.emplace_back(
+          component.name, component.interface_names[i], &values_[index],
+          &write_sequences_[index], &samples_[index]);
+      }
+    }
+    return handles;
+  }
+
+  /// Names of the components of \p ns, in registration order.
+  HARDWARE_INTERFACE_PUBLIC
+  const std::vector<std::string> & get_names(InterfaceNamespace ns) const;
+
+  /// Names of the interfaces of a component, throws std::runtime_error if it isn't registered.
+  HARDWARE_INTERFACE_PUBLIC
+  const std::vector<std::string> & get_interface_names(
+    InterfaceNamespace ns, const std::string & name) const;
+
+  /// Stamp all interfaces of a component.
+  HARDWARE_INTERFACE_PUBLIC
+  return_type set_sample(
+    InterfaceNamespace ns, const std::string & name, const InterfaceSample & sample);
+
+  /// Values of all interfaces, in registration order.
+  HARDWARE_INTERFACE_PUBLIC
+  double * data();
+
+  HARDWARE_INTERFACE_PUBLIC
+  const double * data() const;
+
+  /// Number of registered interfaces of all namespaces.
+  HARDWARE_INTERFACE_PUBLIC
+  size_t size() const;
+
+  /// Write sequence of each value of data().
+  HARDWARE_INTERFACE_PUBLIC
+  WriteSequence * write_sequences();
+
+  /// Sample of each value of data().
+  HARDWARE_INTERFACE_PUBLIC
+  InterfaceSample * samples();
+
+  /**
+   * \brief Keep a copy of all values taken at once by each take_snapshot()
+   *
+   * Freezes the registration, as the snapshot is allocated here at the size of data().
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void enable_snapshot();
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool has_snapshot() const;
+
+  /**
+   * \brief Copy all values to the snapshot in one go, does nothing unless it is enabled
+   *
+   * Called by the control loop right after the hardware is read, so the controllers of the cycle
+   * read the same state whatever the others write to the values. The controller manager does it
+   * in ControllerManager::update(), for its rate groups and for its steps.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void take_snapshot();
+
+  /**
+   * \brief Values at the last take_snapshot(), nullptr before the first one
+   *
+   * For the control loop only, the values don't change until its next take_snapshot().
+   * Index it like data(), e.g. with find() or a generated interface layout.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  const double * get_snapshot() const;
+
+  /**
+   * \brief Copy the last complete snapshot, from any thread and without locking
+   *
+   * The snapshots are double buffered, the copy is only retried if the control loop took two
+   * more snapshots meanwhile.
+   * \return false if no snapshot was taken yet or the copy kept being overwritten
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  bool read_snapshot(std::vector<double> & values) const;
+
+private:
+  struct Component
+  {
+    std::string name;
+    std::vector<std::string> interface_names;
+    // index in the value store of each interface
+    std::vector<size_t> indices;
+  };
+
+  struct Namespace
+  {
+    // kept apart from the components to hand them out by reference
+    std::vector<std::string> names;
+    std::vector<Component> components;
+  };
+
+  return_type check_registration(
+    InterfaceNamespace ns, const std::string & name, const std::string & interface_name) const;
+
+  const Component * find_component(InterfaceNamespace ns, const std::string & name) const;
+
+  std::array<Namespace, 4> namespaces_;
+  // components and interfaces of all namespaces, to their component index and value index
+  std::unordered_map<std::string, size_t> index_;
+
+  std::vector<double> values_;
+  std::vector<WriteSequence> write_sequences_;
+  std::vector<InterfaceSample> samples_;
+
+  bool frozen_ = false;
+
+  bool snapshot_enabled_ = false;
+  std::array<std::vector<double>, 2> snapshots_;
+  // number of snapshots taken, the last one is in snapshots_[count % 2]
+  std::atomic<std::uint64_t> snapshot_count_{0};
+  // number of the snapshot being written, published before it is written
+  std::atomic<std::uint64_t> snapshot_writing_{0};
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__INTERFACE_REGISTRY_HPP_
@@ -15,16 +15,23 @@
 #ifndef HARDWARE_INTERFACE__ROBOT_HARDWARE_HPP_
 #define HARDWARE_INTERFACE__ROBOT_HARDWARE_HPP_
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 
-#include "control_msgs/msg/dynamic_joint_state.hpp"
 #include "hardware_interface/actuator_handle.hpp"
+#include "hardware_interface/command_watchdog.hpp"
+#include "hardware_interface/gpio_handle.hpp"
+#include "hardware_interface/interface_registry.hpp"
 #include "hardware_interface/joint_handle.hpp"
 #include "hardware_interface/operation_mode_handle.hpp"
 #include "hardware_interface/robot_hardware_interface.hpp"
+#include "hardware_interface/sensor_handle.hpp"
+#include "hardware_interface/typed_interface_store.hpp"
 #include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/types/interface_sample.hpp"
 #include "hardware_interface/visibility_control.h"
 
 namespace hardware_interface
@@ -64,12 +71,55 @@ public:
   hardware_interface_ret_t register_joint(
     const std::string & joint_name, const std::string & interface_name, double default_value = 0.0);
 
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t register_sensor(
+    const std::string & sensor_name, const std::string & interface_name,
+    double default_value = 0.0);
+
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t register_gpio(
+    const std::string & gpio_name, const std::string & interface_name, double default_value = 0.0);
+
+  /// Register the interfaces of many actuators at once, see register_joints().
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t register_actuators(
+    const std::vector<InterfaceRegistration> & actuator_interfaces);
+
+  /**
+   * \brief Register a whole table of joint interfaces at once
+   *
+   * Cheaper than registering the interfaces one by one, as the storage is reserved at its
+   * final size. Registers none of them if one is empty or already registered.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t register_joints(
+    const std::vector<InterfaceRegistration> & joint_interfaces);
+
+  /**
+   * \brief Refuse any further interface registration
+   *
+   * Registering may move the values, invalidating the handles already taken. Once frozen,
+   * handles stay valid as long as the hardware, usually done at the end of init().
+   * Getting a handle, or the list of registered ones, freezes the registration as well.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  void freeze_registration();
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_registration_frozen() const;
+
   HARDWARE_INTERFACE_PUBLIC
   hardware_interface_ret_t get_actuator_handle(ActuatorHandle & actuator_handle);
 
   HARDWARE_INTERFACE_PUBLIC
   hardware_interface_ret_t get_joint_handle(JointHandle & joint_handle);
 
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t get_sensor_handle(SensorHandle & sensor_handle);
+
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t get_gpio_handle(GpioHandle & gpio_handle);
+
   HARDWARE_INTERFACE_PUBLIC
   hardware_interface_ret_t get_actuator_handles(
     std::vector<ActuatorHandle> & actuator_handles,
@@ -100,11 +150,88 @@ public:
   HARDWARE_INTERFACE_PUBLIC
   std::vector<JointHandle> get_registered_joints();
 
+  HARDWARE_INTERFACE_PUBLIC
+  std::vector<SensorHandle> get_registered_sensors();
+
+  HARDWARE_INTERFACE_PUBLIC
+  std::vector<GpioHandle> get_registered_gpios();
+
+  /// Stamp all interfaces of an actuator, see set_joint_sample().
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t set_actuator_sample(
+    const std::string & actuator_name, const InterfaceSample & sample);
+
+  /**
+   * \brief Stamp all interfaces of a joint with the time they were sampled at
+   *
+   * Meant for hardware reading a whole component at once, interfaces can also be stamped
+   * one by one through ReadWriteHandle::set_sample().
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t set_joint_sample(
+    const std::string & joint_name, const InterfaceSample & sample);
+
+  /// Watch an actuator command, see watch_joint_command().
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t watch_actuator_command(
+    const std::string & actuator_name, const std::string & interface_name, double safe_value,
+    uint32_t max_stale_cycles = 0);
+
+  /**
+   * \brief Set a joint command to \p safe_value while it isn't written through its handles
+   *
+   * The command is stale once it was left unwritten by more than \p max_stale_cycles calls to
+   * enforce_command_watchdog(). Like getting a handle, watching a command freezes the
+   * registration, so commands should be watched once all interfaces are registered.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  hardware_interface_ret_t watch_joint_command(
+    const std::string & joint_name, const std::string & interface_name, double safe_value,
+    uint32_t max_stale_cycles = 0);
+
+  /**
+   * \brief Apply the safe values of the stale watched commands
+   *
+   * To call between the controller updates and write(), as the controller manager does in
+   * update(), its rate groups and steps. Each call counts as a cycle.
+   * \return the number of stale commands
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  size_t enforce_command_watchdog();
+
+  /**
+   * \brief Interfaces whose values aren't single doubles
+   *
+   * \p T is one of std::uint8_t for booleans and digital I/O, std::int32_t for mode words,
+   * std::uint32_t for bit fields such as status registers and double for fixed-size arrays.
+   */
+  template<typename T>
+  TypedInterfaceStore<T> & get_typed_interfaces()
+  {
+    return std::get<TypedInterfaceStore<T>>(typed_interfaces_);
+  }
+
+  /**
+   * \brief The double interfaces of all actuators, joints, sensors and GPIOs
+   *
+   * Gives access to the names of any namespace and to all values at once, e.g. to copy them.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  InterfaceRegistry & get_interface_registry();
+
 private:
   std::vector<OperationModeHandle *> registered_operation_mode_handles_;
 
-  control_msgs::msg::DynamicJointState registered_actuators_;
-  control_msgs::msg::DynamicJointState registered_joints_;
+  InterfaceRegistry interfaces_;
+
+  CommandWatchdog command_watchdog_;
+
+  std::tuple<
+    TypedInterfaceStore<std::uint8_t>,
+    TypedInterfaceStore<std::int32_t>,
+    TypedInterfaceStore<std::uint32_t>,
+    TypedInterfaceStore<double>
+  > typed_interfaces_;
 };
 
 using RobotHardwareSharedPtr = std::shared_ptr<RobotHardware>;
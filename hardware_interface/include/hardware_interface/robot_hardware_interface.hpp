@@ -15,6 +15,7 @@
 #ifndef HARDWARE_INTERFACE__ROBOT_HARDWARE_INTERFACE_HPP_
 #define HARDWARE_INTERFACE__ROBOT_HARDWARE_INTERFACE_HPP_
 
+#include "hardware_interface/controller_info.hpp"
 #include "hardware_interface/types/hardware_interface_return_values.hpp"
 #include "hardware_interface/visibility_control.h"
 
@@ -42,6 +43,49 @@ public:
   HARDWARE_INTERFACE_PUBLIC
   virtual
   return_type write() = 0;
+
+  /**
+   * \brief Block until the device signals the start of a new cycle.
+   *
+   * Hardware with its own clock, like a fieldbus frame or an interrupt, implements it to drive
+   * hardware-clocked control loops: read(), update and write() run right after it returns.
+   * Should give up with ERROR after a few missed cycles, so the loop can be stopped.
+   * The default implementation returns ERROR without blocking, the caller then keeps its timer.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type wait_for_cycle()
+  {
+    return return_type::ERROR;
+  }
+
+  /**
+   * \brief Check the hardware can switch to the modes needed by the controllers of a switch.
+   *
+   * Called outside of the control loop before the switch is requested, returning ERROR
+   * refuses it. The hardware may also stage the mode changes here, to apply them at once later.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type prepare_mode_switch(const ControllerSwitch & /*controller_switch*/)
+  {
+    return return_type::OK;
+  }
+
+  /**
+   * \brief Apply all the mode changes of a prepared switch.
+   *
+   * Called once from the control loop by the rate group owning the hardware, after every group
+   * with controllers of the switch on it stopped the controllers to stop, so the changes can be
+   * sent in a single bus frame. The controllers to start are started once it returned, and not
+   * at all on ERROR.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  virtual
+  return_type perform_mode_switch(const ControllerSwitch & /*controller_switch*/)
+  {
+    return return_type::OK;
+  }
 };
 
 }  // namespace hardware_interface
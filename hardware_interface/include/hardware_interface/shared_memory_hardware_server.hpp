@@ -0,0 +1,101 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__SHARED_MEMORY_HARDWARE_SERVER_HPP_
+#define HARDWARE_INTERFACE__SHARED_MEMORY_HARDWARE_SERVER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/shared_memory_segment.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+
+/** \brief Serves a RobotHardware to a SharedMemoryRobotHardware in another process
+ *
+ * Serves the joint, actuator, sensor and GPIO interfaces. Runs in the driver process, in
+ * lockstep with the client: each cycle waits for the commands, writes them to the hardware,
+ * reads it and publishes the states. If no commands come within the timeout the client is
+ * considered lost: the hardware keeps being read but is not written until the client is back.
+ */
+class SharedMemoryHardwareServer
+{
+public:
+  struct Options
+  {
+    /** Longest wait for the commands of a cycle. */
+    std::chrono::nanoseconds timeout {std::chrono::milliseconds(10)};
+    /**
+     * Busy wait before sleeping on the futex, only worth it when both processes have their
+     * own CPU: sharing one, the spin just delays the other side.
+     */
+    std::chrono::nanoseconds spin {0};
+    /** Interfaces ending with it are commands, the others are states. */
+    std::string command_suffix = "_command";
+  };
+
+  HARDWARE_INTERFACE_PUBLIC
+  SharedMemoryHardwareServer(
+    std::shared_ptr<RobotHardware> hardware,
+    const std::string & segment_name);
+
+  HARDWARE_INTERFACE_PUBLIC
+  SharedMemoryHardwareServer(
+    std::shared_ptr<RobotHardware> hardware,
+    const std::string & segment_name,
+    const Options & options);
+
+  /// Create the segment for the joints, actuators, sensors and GPIOs of the initialized hardware.
+  HARDWARE_INTERFACE_PUBLIC
+  return_type init();
+
+  /// Run one cycle, ERROR if the hardware failed or no commands came within the timeout.
+  HARDWARE_INTERFACE_PUBLIC
+  return_type run_once();
+
+  /// Run cycles from init() until stop() is called.
+  HARDWARE_INTERFACE_PUBLIC
+  void run();
+
+  HARDWARE_INTERFACE_PUBLIC
+  void stop();
+
+  /// True while the client heartbeat is more recent than the timeout.
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_client_alive() const;
+
+private:
+  void publish_states();
+
+  std::shared_ptr<RobotHardware> hardware_;
+  std::string segment_name_;
+  Options options_;
+  SharedMemorySegment segment_;
+  SharedMemoryBindings bindings_;
+  std::uint32_t last_command_sequence_ = 0;
+  /// Until the first commands, so a server started before its client doesn't report it lost
+  bool client_lost_ = true;
+  std::atomic<bool> running_ {false};
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__SHARED_MEMORY_HARDWARE_SERVER_HPP_
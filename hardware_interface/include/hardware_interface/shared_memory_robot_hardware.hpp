@@ -0,0 +1,97 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__SHARED_MEMORY_ROBOT_HARDWARE_HPP_
+#define HARDWARE_INTERFACE__SHARED_MEMORY_ROBOT_HARDWARE_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/shared_memory_segment.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/visibility_control.h"
+
+namespace hardware_interface
+{
+
+/** \brief Proxy of a RobotHardware running in another process
+ *
+ * Registers the joints, actuators, sensors and GPIOs served by a SharedMemoryHardwareServer,
+ * then exchanges their values through shared memory: read() waits for the states of the next
+ * cycle and write() hands the commands over to the server, which writes and reads the real
+ * hardware. Once the server is lost, read() maps the segment of a restarted server as soon as
+ * it serves the same interfaces.
+ */
+class SharedMemoryRobotHardware : public RobotHardware
+{
+public:
+  struct Options
+  {
+    /** Longest wait for the states, and age of the server heartbeat it is considered lost at. */
+    std::chrono::nanoseconds timeout {std::chrono::milliseconds(10)};
+    /**
+     * Busy wait before sleeping on the futex, only worth it when both processes have their
+     * own CPU: sharing one, the spin just delays the other side.
+     */
+    std::chrono::nanoseconds spin {0};
+  };
+
+  HARDWARE_INTERFACE_PUBLIC
+  explicit SharedMemoryRobotHardware(const std::string & segment_name);
+
+  HARDWARE_INTERFACE_PUBLIC
+  SharedMemoryRobotHardware(const std::string & segment_name, const Options & options);
+
+  /// Open the segment of the server and register its interfaces.
+  HARDWARE_INTERFACE_PUBLIC
+  return_type init() override;
+
+  /**
+   * Wait for the states of the cycle along with their samples, flagging them invalid if they
+   * don't come within the timeout. Fails at once while the server is lost.
+   */
+  HARDWARE_INTERFACE_PUBLIC
+  return_type read() override;
+
+  HARDWARE_INTERFACE_PUBLIC
+  return_type write() override;
+
+  /// True while the server heartbeat is more recent than the timeout.
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_server_alive() const;
+
+private:
+  /// Map the segment of a restarted server in place of the current one, if it is compatible.
+  bool remap_replaced_segment();
+
+  /// Flag the states invalid until the next states are read, keeping their sample time.
+  void invalidate_states();
+
+  std::string segment_name_;
+  Options options_;
+  SharedMemorySegment segment_;
+  SharedMemoryBindings bindings_;
+  std::uint32_t last_state_sequence_ = 0;
+  bool server_lost_ = false;
+  /// False once the states were flagged invalid, until the next states are read
+  bool states_valid_ = true;
+  /// Set once a restarted server with other interfaces was reported
+  bool replaced_segment_rejected_ = false;
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__SHARED_MEMORY_ROBOT_HARDWARE_HPP_
@@ -0,0 +1,257 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__SHARED_MEMORY_SEGMENT_HPP_
+#define HARDWARE_INTERFACE__SHARED_MEMORY_SEGMENT_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/actuator_handle.hpp"
+#include "hardware_interface/gpio_handle.hpp"
+#include "hardware_interface/joint_handle.hpp"
+#include "hardware_interface/robot_hardware.hpp"
+#include "hardware_interface/sensor_handle.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "hardware_interface/types/interface_sample.hpp"
+#include "hardware_interface/visibility_control.h"
+
+// Shared memory transport between a SharedMemoryRobotHardware in the controller manager process
+// and a SharedMemoryHardwareServer in the driver process, only available on Linux.
+
+namespace hardware_interface
+{
+
+/**
+ * Beginning of the segment, followed by the state values, the command values, the samples of
+ * the states and the names.
+ */
+struct SharedMemorySegmentHeader
+{
+  static constexpr std::uint32_t MAGIC = 0x72326863;
+  static constexpr std::uint32_t VERSION = 4;
+
+  /** Written last by the server, the segment is ready once it holds MAGIC. */
+  std::atomic<std::uint32_t> magic;
+  std::uint32_t version;
+  std::uint64_t size;
+  std::uint32_t state_count;
+  std::uint32_t command_count;
+  std::uint32_t names_size;
+  /** Interfaces ending with it are commands, written by the client, the others are states. */
+  char command_suffix[32];
+
+  /** Sequence numbers of the values, odd while they are written, also used as futex words. */
+  alignas(64) std::atomic<std::uint32_t> state_sequence;
+  /** Processes sleeping on the sequence, the writer only wakes them up when there are some. */
+  std::atomic<std::uint32_t> state_waiters;
+  alignas(64) std::atomic<std::uint32_t> command_sequence;
+  std::atomic<std::uint32_t> command_waiters;
+
+  /** Last activity of each side, on the monotonic clock shared by all processes. */
+  alignas(64) std::atomic<std::int64_t> server_heartbeat_ns;
+  alignas(64) std::atomic<std::int64_t> client_heartbeat_ns;
+};
+
+/** Handles of one kind of component, split between states and commands. */
+template<typename HandleType>
+struct SharedMemoryHandles
+{
+  std::vector<HandleType> states;
+  std::vector<HandleType> commands;
+};
+
+/** \brief Handles of a RobotHardware in the order of the values of the segment
+ *
+ * States are the joint, actuator, sensor then GPIO interfaces not ending with the command
+ * suffix, commands the ones ending with it, each in the registration order of the hardware.
+ */
+struct SharedMemoryBindings
+{
+  HARDWARE_INTERFACE_PUBLIC
+  void bind(RobotHardware & hardware, const std::string & command_suffix);
+
+  HARDWARE_INTERFACE_PUBLIC
+  size_t state_count() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  size_t command_count() const;
+
+  /// Copy the state values along with their sample time and validity.
+  HARDWARE_INTERFACE_PUBLIC
+  void copy_states_to(double * values, InterfaceSample * samples) const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  void copy_states_from(const double * values, const InterfaceSample * samples);
+
+  HARDWARE_INTERFACE_PUBLIC
+  void copy_commands_to(double * values) const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  void copy_commands_from(const double * values);
+
+  /// Flag the state values as valid or not, keeping their sample time.
+  HARDWARE_INTERFACE_PUBLIC
+  void set_states_valid(bool valid);
+
+  SharedMemoryHandles<JointHandle> joints;
+  SharedMemoryHandles<ActuatorHandle> actuators;
+  SharedMemoryHandles<SensorHandle> sensors;
+  SharedMemoryHandles<GpioHandle> gpios;
+};
+
+/** \brief POSIX shared memory segment holding the values of a RobotHardware */
+class SharedMemorySegment
+{
+public:
+  HARDWARE_INTERFACE_PUBLIC
+  SharedMemorySegment() = default;
+
+  HARDWARE_INTERFACE_PUBLIC
+  ~SharedMemorySegment();
+
+  SharedMemorySegment(const SharedMemorySegment &) = delete;
+  SharedMemorySegment & operator=(const SharedMemorySegment &) = delete;
+
+  /// Create the segment, replacing the one a crashed server may have left, and own it.
+  HARDWARE_INTERFACE_PUBLIC
+  return_type create(
+    const std::string & name, std::uint32_t state_count, std::uint32_t command_count,
+    const std::string & names, const std::string & command_suffix);
+
+  /// Open a segment created by a server, fails if it is not ready or of another version.
+  HARDWARE_INTERFACE_PUBLIC
+  return_type open(const std::string & name);
+
+  /// Unmap the segment, and remove it if it was created by this object.
+  HARDWARE_INTERFACE_PUBLIC
+  void close();
+
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_open() const;
+
+  /// True if the name now refers to another segment, e.g. created by a restarted server.
+  HARDWARE_INTERFACE_PUBLIC
+  bool is_replaced() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  void swap(SharedMemorySegment & other);
+
+  HARDWARE_INTERFACE_PUBLIC
+  SharedMemorySegmentHeader & header() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  double * states() const;
+
+  HARDWARE_INTERFACE_PUBLIC
+  double * commands() const;
+
+  /// Sample time and validity of each state value.
+  HARDWARE_INTERFACE_PUBLIC
+  InterfaceSample * samples() const;
+
+  /// Names of the values, one entry per interface: 'j', 'a', 's' or 'g', name, '\0', interface,
+  /// '\0'.
+  HARDWARE_INTERFACE_PUBLIC
+  std::string names() const;
+
+private:
+  std::string name_;
+  void * data_ = nullptr;
+  size_t size_ = 0;
+  bool owner_ = false;
+  /// Inode of the mapped segment, told apart from the one of a restarted server
+  std::uint64_t inode_ = 0;
+};
+
+/// Current time of the monotonic clock, comparable between processes.
+HARDWARE_INTERFACE_PUBLIC
+std::int64_t shared_memory_clock_ns();
+
+/**
+ * \brief Wait until \p sequence differs from \p last and its values are not being written.
+ * Busy waits for \p spin first, as sleeping on the futex costs a few microseconds per wake up,
+ * and counts itself in \p waiters while sleeping.
+ * \return false on timeout
+ */
+HARDWARE_INTERFACE_PUBLIC
+bool wait_for_sequence(
+  std::atomic<std::uint32_t> & sequence, std::atomic<std::uint32_t> & waiters,
+  std::uint32_t last, std::chrono::nanoseconds spin, std::chrono::nanoseconds timeout);
+
+/// Wake up the processes waiting on \p sequence.
+HARDWARE_INTERFACE_PUBLIC
+void wake_sequence_waiters(std::atomic<std::uint32_t> & sequence);
+
+/**
+ * \brief Write values guarded by \p sequence, only one process may write them.
+ * The futex is only woken up if \p waiters counts a sleeping reader, saving a system call per
+ * write while the reader spins.
+ */
+template<typename CopyFunction>
+void write_sequenced_values(
+  std::atomic<std::uint32_t> & sequence, std::atomic<std::uint32_t> & waiters,
+  CopyFunction copy)
+{
+  const std::uint32_t current = sequence.load(std::memory_order_relaxed);
+  sequence.store(current + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  copy();
+  sequence.store(current + 2, std::memory_order_release);
+  // orders the store before the load, pairing with the increment of a reader about to sleep
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiters.load(std::memory_order_relaxed) != 0) {
+    wake_sequence_waiters(sequence);
+  }
+}
+
+/**
+ * \brief Read values guarded by \p sequence, again if they were written meanwhile.
+ * Gives up after \p timeout, as a writer dying in the middle of a write leaves it odd forever.
+ * \param[out] read_sequence sequence number of the values read
+ * \return ERROR on timeout, the values copied may then be torn
+ */
+template<typename CopyFunction>
+return_type read_sequenced_values(
+  std::atomic<std::uint32_t> & sequence, std::chrono::nanoseconds timeout, CopyFunction copy,
+  std::uint32_t & read_sequence)
+{
+  std::int64_t deadline_ns = 0;
+  while (true) {
+    const std::uint32_t current = sequence.load(std::memory_order_acquire);
+    if (!(current & 1)) {
+      copy();
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) == current) {
+        read_sequence = current;
+        return return_type::OK;
+      }
+    }
+    // the clock is only read once the first attempt failed
+    const std::int64_t now_ns = shared_memory_clock_ns();
+    if (deadline_ns == 0) {
+      deadline_ns = now_ns + timeout.count();
+    } else if (now_ns >= deadline_ns) {
+      return return_type::ERROR;
+    }
+  }
+}
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__SHARED_MEMORY_SEGMENT_HPP_
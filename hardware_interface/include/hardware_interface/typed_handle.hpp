@@ -0,0 +1,146 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__TYPED_HANDLE_HPP_
+#define HARDWARE_INTERFACE__TYPED_HANDLE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "hardware_interface/macros.hpp"
+
+namespace hardware_interface
+{
+/** \brief A handle used to get and set the values of an interface that isn't a double
+ *
+ * The interface holds \ref size() values of type \p T, one unless it is a fixed-size array.
+ */
+template<typename T>
+class TypedHandle
+{
+public:
+  TypedHandle(
+    const std::string & name,
+    const std::string & interface_name,
+    T * value_ptr = nullptr,
+    size_t size = 1)
+  : name_(name), interface_name_(interface_name), value_ptr_(value_ptr), size_(size)
+  {
+  }
+
+  /// \brief returns true if handle references a value
+  inline operator bool() const {return value_ptr_ != nullptr;}
+
+  TypedHandle with_value_ptr(T * value_ptr, size_t size) const
+  {
+    return TypedHandle(name_, interface_name_, value_ptr, size);
+  }
+
+  const std::string & get_name() const
+  {
+    return name_;
+  }
+
+  const std::string & get_interface_name() const
+  {
+    return interface_name_;
+  }
+
+  /// \brief returns the number of values of the interface
+  size_t size() const
+  {
+    return size_;
+  }
+
+  T get_value(size_t index = 0) const
+  {
+    THROW_ON_NULLPTR(value_ptr_);
+    check_index(index);
+    return value_ptr_[index];
+  }
+
+  void set_value(T value, size_t index = 0)
+  {
+    THROW_ON_NULLPTR(value_ptr_);
+    check_index(index);
+    value_ptr_[index] = value;
+  }
+
+  /// \brief returns the contiguous values of the interface, to copy them in bulk
+  T * data()
+  {
+    THROW_ON_NULLPTR(value_ptr_);
+    return value_ptr_;
+  }
+
+  const T * data() const
+  {
+    THROW_ON_NULLPTR(value_ptr_);
+    return value_ptr_;
+  }
+
+  /// \brief returns a bit of an unsigned integer interface such as a status register
+  bool get_bit(size_t bit, size_t index = 0) const
+  {
+    static_assert(std::is_unsigned<T>::value, "only unsigned integers are bit fields");
+    check_bit(bit);
+    return (get_value(index) >> bit) & 1u;
+  }
+
+  void set_bit(size_t bit, bool value, size_t index = 0)
+  {
+    static_assert(std::is_unsigned<T>::value, "only unsigned integers are bit fields");
+    check_bit(bit);
+    const T mask = static_cast<T>(T(1) << bit);
+    set_value(static_cast<T>(value ? get_value(index) | mask : get_value(index) & ~mask), index);
+  }
+
+private:
+  void check_index(size_t index) const
+  {
+    if (index >= size_) {
+      throw std::out_of_range(
+              "index " + std::to_string(index) + " of interface " + name_ + ": " +
+              interface_name_ + " is out of range");
+    }
+  }
+
+  static void check_bit(size_t bit)
+  {
+    if (bit >= sizeof(T) * 8) {
+      throw std::out_of_range("bit " + std::to_string(bit) + " is out of range");
+    }
+  }
+
+  std::string name_;
+  std::string interface_name_;
+  T * value_ptr_;
+  size_t size_;
+};
+
+/** Handle of a boolean or byte interface, e.g. a digital input or output. */
+using UInt8Handle = TypedHandle<std::uint8_t>;
+/** Handle of a signed integer interface, e.g. a mode word or an encoder count. */
+using Int32Handle = TypedHandle<std::int32_t>;
+/** Handle of a bit field interface, e.g. a status or control register. */
+using BitFieldHandle = TypedHandle<std::uint32_t>;
+/** Handle of a fixed-size array of doubles, e.g. the values of a force torque sensor. */
+using DoubleArrayHandle = TypedHandle<double>;
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__TYPED_HANDLE_HPP_
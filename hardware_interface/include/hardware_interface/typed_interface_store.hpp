@@ -0,0 +1,143 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__TYPED_INTERFACE_STORE_HPP_
+#define HARDWARE_INTERFACE__TYPED_INTERFACE_STORE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/typed_handle.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+#include "rcutils/logging_macros.h"
+
+namespace hardware_interface
+{
+/** \brief Contiguous storage of the interfaces of one value type
+ *
+ * The values of all interfaces are stored back to back in registration order, so a driver can
+ * copy its whole process image to and from the bus at once through data().
+ * Like for joints and actuators, registering interfaces may move the values, so handing out the
+ * first handle freezes the registration.
+ */
+template<typename T>
+class TypedInterfaceStore
+{
+public:
+  struct Interface
+  {
+    std::string name;
+    std::string interface_name;
+    /// Index of the first value of the interface in data()
+    size_t offset;
+    size_t size;
+  };
+
+  TypedInterfaceStore()
+  : TypedInterfaceStore("typed interface handle")
+  {}
+
+  explicit TypedInterfaceStore(const std::string & logger_name)
+  : logger_name_(logger_name)
+  {}
+
+  /// Register an interface of \p size values, more than one for a fixed-size array.
+  return_type register_interface(
+    const std::string & name, const std::string & interface_name, T default_value = T(),
+    size_t size = 1)
+  {
+    if (frozen_) {
+      RCUTILS_LOG_ERROR_NAMED(
+        logger_name_.c_str(), "cannot register interface! Registration is frozen");
+      return return_type::ERROR;
+    }
+    if (name.empty() || interface_name.empty() || size == 0) {
+      RCUTILS_LOG_ERROR_NAMED(
+        logger_name_.c_str(), "interface name is empty or it has no values!");
+      return return_type::ERROR;
+    }
+    if (find(name, interface_name) != interfaces_.end()) {
+      RCUTILS_LOG_ERROR_NAMED(
+        logger_name_.c_str(), "interface (%s: %s) is already registered!",
+        name.c_str(), interface_name.c_str());
+      return return_type::ERROR;
+    }
+    interfaces_.push_back({name, interface_name, values_.size(), size});
+    values_.insert(values_.end(), size, default_value);
+    return return_type::OK;
+  }
+
+  /// Bind \p handle to the values of the interface of the same name, freezing the registration.
+  return_type get_handle(TypedHandle<T> & handle)
+  {
+    const auto it = find(handle.get_name(), handle.get_interface_name());
+    if (it == interfaces_.end()) {
+      RCUTILS_LOG_ERROR_NAMED(
+        logger_name_.c_str(), "interface (%s: %s) wasn't found!",
+        handle.get_name().c_str(), handle.get_interface_name().c_str());
+      return return_type::ERROR;
+    }
+    frozen_ = true;
+    handle = handle.with_value_ptr(&values_[it->offset], it->size);
+    return return_type::OK;
+  }
+
+  bool is_frozen() const
+  {
+    return frozen_;
+  }
+
+  const std::vector<Interface> & get_registered_interfaces() const
+  {
+    return interfaces_;
+  }
+
+  /// Values of all interfaces, in registration order.
+  T * data()
+  {
+    return values_.data();
+  }
+
+  const T * data() const
+  {
+    return values_.data();
+  }
+
+  /// Number of values of all interfaces.
+  size_t size() const
+  {
+    return values_.size();
+  }
+
+private:
+  typename std::vector<Interface>::const_iterator find(
+    const std::string & name, const std::string & interface_name) const
+  {
+    return std::find_if(
+      interfaces_.begin(), interfaces_.end(), [&](const Interface & interface) {
+        return interface.name == name && interface.interface_name == interface_name;
+      });
+  }
+
+  std::string logger_name_;
+  std::vector<Interface> interfaces_;
+  std::vector<T> values_;
+  bool frozen_ = false;
+};
+
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__TYPED_INTERFACE_STORE_HPP_
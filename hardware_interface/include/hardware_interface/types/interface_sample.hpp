@@ -0,0 +1,32 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__TYPES__INTERFACE_SAMPLE_HPP_
+#define HARDWARE_INTERFACE__TYPES__INTERFACE_SAMPLE_HPP_
+
+#include "rcutils/time.h"
+
+namespace hardware_interface
+{
+/** When the value of an interface was sampled by the hardware, and whether it can be used. */
+struct InterfaceSample
+{
+  /// Time of the measurement in nanoseconds, 0 if the hardware doesn't stamp its values.
+  rcutils_time_point_value_t time = 0;
+  /// False while the hardware has no valid measurement, e.g. a sensor that isn't ready.
+  bool valid = true;
+};
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__TYPES__INTERFACE_SAMPLE_HPP_
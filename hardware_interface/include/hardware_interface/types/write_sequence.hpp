@@ -0,0 +1,61 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HARDWARE_INTERFACE__TYPES__WRITE_SEQUENCE_HPP_
+#define HARDWARE_INTERFACE__TYPES__WRITE_SEQUENCE_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+namespace hardware_interface
+{
+/** \brief Number of writes of an interface value, counted by controllers and read by the loop
+ *
+ * A relaxed atomic: it only tells whether the value was written since the last look, so a
+ * write costs a plain load and store, each command having a single writer. Copyable so it can
+ * be stored in vectors, the copy itself is not atomic.
+ */
+class WriteSequence
+{
+public:
+  explicit WriteSequence(std::uint64_t value = 0) noexcept
+  : value_(value)
+  {}
+
+  WriteSequence(const WriteSequence & other) noexcept
+  : value_(other.load())
+  {}
+
+  WriteSequence & operator=(const WriteSequence & other) noexcept
+  {
+    value_.store(other.load(), std::memory_order_relaxed);
+    return *this;
+  }
+
+  std::uint64_t load() const noexcept
+  {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+  void increment() noexcept
+  {
+    value_.store(load() + 1, std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<std::uint64_t> value_;
+};
+}  // namespace hardware_interface
+
+#endif  // HARDWARE_INTERFACE__TYPES__WRITE_SEQUENCE_HPP_
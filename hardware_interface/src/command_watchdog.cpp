@@ -0,0 +1,83 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/command_watchdog.hpp"
+
+namespace hardware_interface
+{
+
+void CommandWatchdog::watch(
+  double * value, const WriteSequence * write_sequence, double safe_value,
+  std::uint32_t max_stale_cycles)
+{
+  values_.push_back(value);
+  write_sequences_.push_back(write_sequence);
+  safe_values_.push_back(safe_value);
+  max_stale_cycles_.push_back(max_stale_cycles);
+  stale_cycles_.push_back(0);
+  last_sequences_.push_back(write_sequence->load());
+  sequences_.push_back(write_sequence->load());
+}
+
+void CommandWatchdog::clear()
+{
+  values_.clear();
+  write_sequences_.clear();
+  safe_values_.clear();
+  max_stale_cycles_.clear();
+  stale_cycles_.clear();
+  last_sequences_.clear();
+  sequences_.clear();
+}
+
+size_t CommandWatchdog::size() const
+{
+  return values_.size();
+}
+
+size_t CommandWatchdog::enforce()
+{
+  const size_t count = values_.size();
+  for (size_t i = 0; i < count; ++i) {
+    sequences_[i] = write_sequences_[i]->load();
+  }
+
+  // branchless on plain arrays so the compiler can vectorize it,
+  // stale counts saturate one cycle past their limit
+  const std::uint64_t * sequences = sequences_.data();
+  const std::uint64_t * max_stale_cycles = max_stale_cycles_.data();
+  std::uint64_t * last_sequences = last_sequences_.data();
+  std::uint64_t * stale_cycles = stale_cycles_.data();
+  size_t stale_count = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const bool written = sequences[i] != last_sequences[i];
+    const std::uint64_t cycles = stale_cycles[i] + (stale_cycles[i] <= max_stale_cycles[i]);
+    stale_cycles[i] = written ? 0 : cycles;
+    last_sequences[i] = sequences[i];
+    stale_count += stale_cycles[i] > max_stale_cycles[i];
+  }
+  if (stale_count == 0) {
+    return 0;
+  }
+
+  // not counted as writes, the commands stay stale until a controller writes them again
+  for (size_t i = 0; i < count; ++i) {
+    if (stale_cycles_[i] > max_stale_cycles_[i]) {
+      *values_[i] = safe_values_[i];
+    }
+  }
+  return stale_count;
+}
+
+}  // namespace hardware_interface
@@ -0,0 +1,297 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/interface_registry.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+
+namespace
+{
+constexpr const char * kLoggerNames[] = {
+  "actuator handle", "joint handle", "sensor handle", "gpio handle"};
+
+const char * logger_name(hardware_interface::InterfaceNamespace ns)
+{
+  return kLoggerNames[static_cast<size_t>(ns)];
+}
+
+/// Key of a component in the index, or of one of its interfaces if \p interface_name is given.
+std::string make_key(
+  hardware_interface::InterfaceNamespace ns, const std::string & name,
+  const std::string & interface_name = "")
+{
+  std::string key;
+  key.reserve(name.size() + interface_name.size() + 2);
+  key += static_cast<char>('0' + static_cast<int>(ns));
+  key += name;
+  key += '\0';
+  key += interface_name;
+  return key;
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+constexpr size_t InterfaceRegistry::npos;
+
+return_type InterfaceRegistry::check_registration(
+  InterfaceNamespace ns, const std::string & name, const std::string & interface_name) const
+{
+  if (frozen_) {
+    RCUTILS_LOG_ERROR_NAMED(
+      logger_name(ns), "cannot register handle! Registration is frozen");
+    return return_type::ERROR;
+  }
+  if (name.empty() || interface_name.empty()) {
+    RCUTILS_LOG_ERROR_NAMED(logger_name(ns), "handle name or interface is empty!");
+    return return_type::ERROR;
+  }
+  if (find(ns, name, interface_name) != npos) {
+    RCUTILS_LOG_ERROR_NAMED(
+      logger_name(ns), "handle with interface (%s: %s) is already registered!",
+      name.c_str(), interface_name.c_str());
+    return return_type::ERROR;
+  }
+  return return_type::OK;
+}
+
+return_type InterfaceRegistry::register_interface(
+  InterfaceNamespace ns, const std::string & name, const std::string & interface_name,
+  double default_value)
+{
+  return register_interfaces(ns, {{name, interface_name, default_value}});
+}
+
+return_type InterfaceRegistry::register_interfaces(
+  InterfaceNamespace ns, const std::vector<InterfaceRegistration> & interfaces)
+{
+  auto & space = namespaces_[static_cast<size_t>(ns)];
+
+  // validate the whole table first, counting the interfaces added to each component
+  std::unordered_set<std::string> new_keys;
+  new_keys.reserve(interfaces.size());
+  std::unordered_map<std::string, size_t> added_counts;
+  std::vector<std::string> new_names;
+  for (const auto & interface : interfaces) {
+    if (check_registration(ns, interface.name, interface.interface_name) != return_type::OK) {
+      return return_type::ERROR;
+    }
+    if (!new_keys.insert(make_key(ns, interface.name, interface.interface_name)).second) {
+      RCUTILS_LOG_ERROR_NAMED(
+        logger_name(ns), "handle with interface (%s: %s) is registered twice!",
+        interface.name.c_str(), interface.interface_name.c_str());
+      return return_type::ERROR;
+    }
+    if (++added_counts[interface.name] == 1 && !find_component(ns, interface.name)) {
+      new_names.push_back(interface.name);
+    }
+  }
+
+  // then reserve everything at its final size, so nothing is moved more than once
+  const size_t value_count = values_.size() + interfaces.size();
+  values_.reserve(value_count);
+  write_sequences_.reserve(value_count);
+  samples_.reserve(value_count);
+  index_.reserve(index_.size() + interfaces.size() + new_names.size());
+  space.names.reserve(space.names.size() + new_names.size());
+  space.components.reserve(space.components.size() + new_names.size());
+  for (const auto & name : new_names) {
+    index_.emplace(make_key(ns, name), space.components.size());
+    space.names.push_back(name);
+    space.components.push_back({name, {}, {}});
+  }
+  for (const auto & added : added_counts) {
+    auto & component = space.components[index_.at(make_key(ns, added.first))];
+    component.interface_names.reserve(component.interface_names.size() + added.second);
+    component.indices.reserve(component.indices.size() + added.second);
+  }
+
+  for (const auto & interface : interfaces) {
+    auto & component = space.components[index_.at(make_key(ns, interface.name))];
+    const size_t index = values_.size();
+    index_.emplace(make_key(ns, interface.name, interface.interface_name), index);
+    component.interface_names.push_back(interface.interface_name);
+    component.indices.push_back(index);
+    values_.push_back(interface.default_value);
+    write_sequences_.emplace_back();
+    samples_.emplace_back();
+  }
+  return return_type::OK;
+}
+
+void InterfaceRegistry::freeze()
+{
+  frozen_ = true;
+}
+
+bool InterfaceRegistry::is_frozen() const
+{
+  return frozen_;
+}
+
+size_t InterfaceRegistry::find(
+  InterfaceNamespace ns, const std::string & name, const std::string & interface_name) const
+{
+  if (name.empty() || interface_name.empty()) {
+    return npos;
+  }
+  const auto it = index_.find(make_key(ns, name, interface_name));
+  return it == index_.end() ? npos : it->second;
+}
+
+return_type InterfaceRegistry::find_interface(
+  InterfaceNamespace ns, const std::string & name, const std::string & interface_name,
+  size_t & index) const
+{
+  if (name.empty() || interface_name.empty()) {
+    RCUTILS_LOG_ERROR_NAMED(logger_name(ns), "name or interface is ill-defined!");
+    return return_type::ERROR;
+  }
+  index = find(ns, name, interface_name);
+  if (index == npos) {
+    RCUTILS_LOG_ERROR_NAMED(
+      logger_name(ns), "handle with interface (%s: %s) wasn't found!",
+      name.c_str(), interface_name.c_str());
+    return return_type::ERROR;
+  }
+  return return_type::OK;
+}
+
+const InterfaceRegistry::Component * InterfaceRegistry::find_component(
+  InterfaceNamespace ns, const std::string & name) const
+{
+  const auto it = index_.find(make_key(ns, name));
+  if (it == index_.end()) {
+    return nullptr;
+  }
+  return &namespaces_[static_cast<size_t>(ns)].components[it->second];
+}
+
+const std::vector<std::string> & InterfaceRegistry::get_names(InterfaceNamespace ns) const
+{
+  return namespaces_[static_cast<size_t>(ns)].names;
+}
+
+const std::vector<std::string> & InterfaceRegistry::get_interface_names(
+  InterfaceNamespace ns, const std::string & name) const
+{
+  const auto component = find_component(ns, name);
+  if (!component) {
+    throw std::runtime_error(name + " not found");
+  }
+  return component->interface_names;
+}
+
+return_type InterfaceRegistry::set_sample(
+  InterfaceNamespace ns, const std::string & name, const InterfaceSample & sample)
+{
+  const auto component = find_component(ns, name);
+  if (!component) {
+    RCUTILS_LOG_ERROR_NAMED(logger_name(ns), "handle with name %s not found!", name.c_str());
+    return return_type::ERROR;
+  }
+  for (const auto index : component->indices) {
+    samples_[index] = sample;
+  }
+  return return_type::OK;
+}
+
+double * InterfaceRegistry::data()
+{
+  return values_.data();
+}
+
+const double * InterfaceRegistry::data() const
+{
+  return values_.data();
+}
+
+size_t InterfaceRegistry::size() const
+{
+  return values_.size();
+}
+
+WriteSequence * InterfaceRegistry::write_sequences()
+{
+  return write_sequences_.data();
+}
+
+InterfaceSample * InterfaceRegistry::samples()
+{
+  return samples_.data();
+}
+
+void InterfaceRegistry::enable_snapshot()
+{
+  freeze();
+  for (auto & snapshot : snapshots_) {
+    snapshot.assign(values_.size(), 0.0);
+  }
+  snapshot_enabled_ = true;
+}
+
+bool InterfaceRegistry::has_snapshot() const
+{
+  return snapshot_enabled_;
+}
+
+void InterfaceRegistry::take_snapshot()
+{
+  if (!snapshot_enabled_) {
+    return;
+  }
+  // seqlock-like, readers of the buffer being written see it was reused and retry
+  const std::uint64_t count = snapshot_count_.load(std::memory_order_relaxed) + 1;
+  snapshot_writing_.store(count, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(snapshots_[count % 2].data(), values_.data(), values_.size() * sizeof(double));
+  snapshot_count_.store(count, std::memory_order_release);
+}
+
+const double * InterfaceRegistry::get_snapshot() const
+{
+  const std::uint64_t count = snapshot_count_.load(std::memory_order_relaxed);
+  return count ? snapshots_[count % 2].data() : nullptr;
+}
+
+bool InterfaceRegistry::read_snapshot(std::vector<double> & values) const
+{
+  constexpr int kMaxAttempts = 3;
+  values.resize(values_.size());
+  for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+    const std::uint64_t count = snapshot_count_.load(std::memory_order_acquire);
+    if (count == 0) {
+      return false;
+    }
+    std::memcpy(values.data(), snapshots_[count % 2].data(), values.size() * sizeof(double));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // the buffer is only written again by the snapshot after the next one
+    if (snapshot_writing_.load(std::memory_order_relaxed) < count + 2) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace hardware_interface
@@ -25,8 +25,6 @@
 namespace
 {
 constexpr auto kOperationModeLoggerName = "joint operation mode handle";
-constexpr auto kActuatorLoggerName = "actuator handle";
-constexpr auto kJointLoggerName = "joint handle";
 }
 
 namespace hardware_interface
@@ -150,53 +148,13 @@ RobotHardware::get_registered_operation_mode_handles()
   return registered_operation_mode_handles_;
 }
 
-hardware_interface_ret_t register_handle(
-  const std::string & handle_name,
-  const std::string & interface_name,
-  const double default_value,
-  control_msgs::msg::DynamicJointState & registered,
-  const std::string & logger_name)
-{
-  if (handle_name.empty() || interface_name.empty()) {
-    RCUTILS_LOG_ERROR_NAMED(logger_name.c_str(), "handle name or interface is empty!");
-    return return_type::ERROR;
-  }
-
-  const auto & names_list = registered.joint_names;
-  const auto it = std::find(names_list.cbegin(), names_list.cend(), handle_name);
-  if (it == names_list.cend()) {
-    registered.joint_names.push_back(handle_name);
-    control_msgs::msg::InterfaceValue iv;
-    iv.interface_names = {interface_name};
-    iv.values = {default_value};
-    registered.interface_values.push_back(iv);
-    return return_type::OK;
-  } else {
-    const auto index = std::distance(names_list.cbegin(), it);
-    auto & ivs = registered.interface_values[static_cast<size_t>(index)];
-    const auto interface_names = ivs.interface_names;
-    const auto it = std::find(interface_names.cbegin(), interface_names.cend(), interface_name);
-    if (it == interface_names.cend()) {
-      ivs.interface_names.push_back(interface_name);
-      ivs.values.push_back(default_value);
-      return return_type::OK;
-    } else {
-      RCUTILS_LOG_ERROR_NAMED(
-        logger_name.c_str(), "handle with interface (%s: %s) is already registered!",
-        handle_name.c_str(), interface_name.c_str());
-      return return_type::ERROR;
-    }
-  }
-}
-
 hardware_interface_ret_t RobotHardware::register_actuator(
   const std::string & actuator_name,
   const std::string & interface_name,
   const double default_value)
 {
-  return register_handle(
-    actuator_name, interface_name, default_value, registered_actuators_,
-    kActuatorLoggerName);
+  return interfaces_.register_interface(
+    InterfaceNamespace::ACTUATOR, actuator_name, interface_name, default_value);
 }
 
 hardware_interface_ret_t RobotHardware::register_joint(
@@ -204,60 +162,68 @@ hardware_interface_ret_t RobotHardware::register_joint(
   const std::string & interface_name,
   double default_value)
 {
-  return register_handle(
-    joint_name, interface_name, default_value, registered_joints_,
-    kJointLoggerName);
+  return interfaces_.register_interface(
+    InterfaceNamespace::JOINT, joint_name, interface_name, default_value);
 }
 
-template<class HandleType>
-hardware_interface_ret_t get_handle(
-  HandleType & handle,
-  control_msgs::msg::DynamicJointState & registered,
-  const std::string & logger_name)
+hardware_interface_ret_t RobotHardware::register_sensor(
+  const std::string & sensor_name,
+  const std::string & interface_name,
+  double default_value)
 {
-  const auto & handle_name = handle.get_name();
-  const auto & interface_name = handle.get_interface_name();
+  return interfaces_.register_interface(
+    InterfaceNamespace::SENSOR, sensor_name, interface_name, default_value);
+}
 
-  if (handle_name.empty() || interface_name.empty()) {
-    RCUTILS_LOG_ERROR_NAMED(logger_name.c_str(), "name or interface is ill-defined!");
-    return return_type::ERROR;
-  }
+hardware_interface_ret_t RobotHardware::register_gpio(
+  const std::string & gpio_name,
+  const std::string & interface_name,
+  double default_value)
+{
+  return interfaces_.register_interface(
+    InterfaceNamespace::GPIO, gpio_name, interface_name, default_value);
+}
 
-  const auto & names_list = registered.joint_names;
-  const auto it = std::find(names_list.cbegin(), names_list.cend(), handle_name);
-  if (it == names_list.cend()) {
-    RCUTILS_LOG_ERROR_NAMED(
-      logger_name.c_str(), "handle with name %s not found!",
-      handle_name.c_str());
-    return return_type::ERROR;
-  }
+hardware_interface_ret_t RobotHardware::register_actuators(
+  const std::vector<InterfaceRegistration> & actuator_interfaces)
+{
+  return interfaces_.register_interfaces(InterfaceNamespace::ACTUATOR, actuator_interfaces);
+}
 
-  const auto index = std::distance(names_list.cbegin(), it);
-  auto & ivs = registered.interface_values[static_cast<size_t>(index)];
-  const auto interface_names = ivs.interface_names;
-  const auto if_it = std::find(interface_names.cbegin(), interface_names.cend(), interface_name);
-  if (if_it != interface_names.cend()) {
-    const auto value_index = std::distance(interface_names.cbegin(), if_it);
-    handle = handle.with_value_ptr(&(ivs.values[static_cast<size_t>(value_index)]));
-    return return_type::OK;
-  } else {
-    RCUTILS_LOG_ERROR_NAMED(
-      logger_name.c_str(),
-      "handle with interface (%s: %s) wasn't found!", handle_name.c_str(), interface_name.c_str());
-    return return_type::ERROR;
-  }
+hardware_interface_ret_t RobotHardware::register_joints(
+  const std::vector<InterfaceRegistration> & joint_interfaces)
+{
+  return interfaces_.register_interfaces(InterfaceNamespace::JOINT, joint_interfaces);
+}
 
-  return return_type::ERROR;
+void RobotHardware::freeze_registration()
+{
+  interfaces_.freeze();
+}
+
+bool RobotHardware::is_registration_frozen() const
+{
+  return interfaces_.is_frozen();
 }
 
 hardware_interface_ret_t RobotHardware::get_actuator_handle(ActuatorHandle & actuator_handle)
 {
-  return get_handle<ActuatorHandle>(actuator_handle, registered_actuators_, kActuatorLoggerName);
+  return interfaces_.get_handle(InterfaceNamespace::ACTUATOR, actuator_handle);
 }
 
 hardware_interface_ret_t RobotHardware::get_joint_handle(JointHandle & joint_handle)
 {
-  return get_handle<JointHandle>(joint_handle, registered_joints_, kJointLoggerName);
+  return interfaces_.get_handle(InterfaceNamespace::JOINT, joint_handle);
+}
+
+hardware_interface_ret_t RobotHardware::get_sensor_handle(SensorHandle & sensor_handle)
+{
+  return interfaces_.get_handle(InterfaceNamespace::SENSOR, sensor_handle);
+}
+
+hardware_interface_ret_t RobotHardware::get_gpio_handle(GpioHandle & gpio_handle)
+{
+  return interfaces_.get_handle(InterfaceNamespace::GPIO, gpio_handle);
 }
 
 template<class HandleType>
@@ -288,77 +254,109 @@ hardware_interface_ret_t RobotHardware::get_joint_handles(
 
 const std::vector<std::string> & RobotHardware::get_registered_actuator_names()
 {
-  return registered_actuators_.joint_names;
+  return interfaces_.get_names(InterfaceNamespace::ACTUATOR);
 }
 
 const std::vector<std::string> & RobotHardware::get_registered_joint_names()
 {
-  return registered_joints_.joint_names;
+  return interfaces_.get_names(InterfaceNamespace::JOINT);
 }
 
-template<class HandleType>
-const std::vector<std::string> & get_registered_interface_names(
-  const std::string & name,
-  control_msgs::msg::DynamicJointState & registered)
+const std::vector<std::string> & RobotHardware::get_registered_actuator_interface_names(
+  const std::string & actuator_name)
 {
-  const auto & it = std::find(
-    registered.joint_names.begin(), registered.joint_names.end(), name);
-
-  if (it == registered.joint_names.end()) {
-    throw std::runtime_error(name + " not found");
-  }
+  return interfaces_.get_interface_names(InterfaceNamespace::ACTUATOR, actuator_name);
+}
 
-  // joint found, can safely cast here
-  const auto joint_index =
-    static_cast<uint64_t>(std::distance(registered.joint_names.begin(), it));
+const std::vector<std::string> & RobotHardware::get_registered_joint_interface_names(
+  const std::string & joint_name)
+{
+  return interfaces_.get_interface_names(InterfaceNamespace::JOINT, joint_name);
+}
 
-  return registered.interface_values[joint_index].interface_names;
+std::vector<ActuatorHandle> RobotHardware::get_registered_actuators()
+{
+  return interfaces_.get_handles<ActuatorHandle>(InterfaceNamespace::ACTUATOR);
 }
 
-const std::vector<std::string> & RobotHardware::get_registered_actuator_interface_names(
-  const std::string & actuator_name)
+std::vector<JointHandle> RobotHardware::get_registered_joints()
 {
-  return get_registered_interface_names<ActuatorHandle>(actuator_name, registered_actuators_);
+  return interfaces_.get_handles<JointHandle>(InterfaceNamespace::JOINT);
 }
 
-const std::vector<std::string> & RobotHardware::get_registered_joint_interface_names(
-  const std::string & joint_name)
+std::vector<SensorHandle> RobotHardware::get_registered_sensors()
 {
-  return get_registered_interface_names<JointHandle>(joint_name, registered_joints_);
+  return interfaces_.get_handles<SensorHandle>(InterfaceNamespace::SENSOR);
 }
 
-template<class HandleType>
-std::vector<HandleType> get_registered_handles(control_msgs::msg::DynamicJointState & registered)
+std::vector<GpioHandle> RobotHardware::get_registered_gpios()
 {
-  std::vector<HandleType> result;
-  result.reserve(registered.joint_names.size());    // rough estimate
+  return interfaces_.get_handles<GpioHandle>(InterfaceNamespace::GPIO);
+}
 
-  auto & handle_names = registered.joint_names;
-  auto & interface_values = registered.interface_values;
+hardware_interface_ret_t RobotHardware::set_actuator_sample(
+  const std::string & actuator_name, const InterfaceSample & sample)
+{
+  return interfaces_.set_sample(InterfaceNamespace::ACTUATOR, actuator_name, sample);
+}
 
-  assert(registered.joint_names.size() == registered.interface_values.size());
-  for (auto i = 0u; i < handle_names.size(); ++i) {
-    auto & jointernal_interfaces = interface_values[i];
-    assert(jointernal_interfaces.interface_names.size() == jointernal_interfaces.values.size());
+hardware_interface_ret_t RobotHardware::set_joint_sample(
+  const std::string & joint_name, const InterfaceSample & sample)
+{
+  return interfaces_.set_sample(InterfaceNamespace::JOINT, joint_name, sample);
+}
 
-    for (auto j = 0u; j < jointernal_interfaces.interface_names.size(); ++j) {
-      result.emplace_back(
-        handle_names[i], jointernal_interfaces.interface_names[j],
-        &jointernal_interfaces.values[j]);
-    }
+namespace
+{
+/// Watch a command of \p interfaces, freezing the registration like handing out a handle.
+hardware_interface_ret_t watch_command(
+  CommandWatchdog & command_watchdog,
+  InterfaceRegistry & interfaces,
+  InterfaceNamespace ns,
+  const std::string & name,
+  const std::string & interface_name,
+  double safe_value,
+  uint32_t max_stale_cycles)
+{
+  size_t index = 0;
+  if (interfaces.find_interface(ns, name, interface_name, index) != return_type::OK) {
+    return return_type::ERROR;
   }
+  // the watchdog keeps pointers to the value and its write sequence
+  interfaces.freeze();
+  command_watchdog.watch(
+    interfaces.data() + index, interfaces.write_sequences() + index, safe_value,
+    max_stale_cycles);
+  return return_type::OK;
+}
+}  // namespace
 
-  return result;
+hardware_interface_ret_t RobotHardware::watch_actuator_command(
+  const std::string & actuator_name, const std::string & interface_name, double safe_value,
+  uint32_t max_stale_cycles)
+{
+  return watch_command(
+    command_watchdog_, interfaces_, InterfaceNamespace::ACTUATOR, actuator_name, interface_name,
+    safe_value, max_stale_cycles);
 }
 
-std::vector<ActuatorHandle> RobotHardware::get_registered_actuators()
+hardware_interface_ret_t RobotHardware::watch_joint_command(
+  const std::string & joint_name, const std::string & interface_name, double safe_value,
+  uint32_t max_stale_cycles)
 {
-  return get_registered_handles<ActuatorHandle>(registered_actuators_);
+  return watch_command(
+    command_watchdog_, interfaces_, InterfaceNamespace::JOINT, joint_name, interface_name,
+    safe_value, max_stale_cycles);
 }
 
-std::vector<JointHandle> RobotHardware::get_registered_joints()
+size_t RobotHardware::enforce_command_watchdog()
+{
+  return command_watchdog_.enforce();
+}
+
+InterfaceRegistry & RobotHardware::get_interface_registry()
 {
-  return get_registered_handles<JointHandle>(registered_joints_);
+  return interfaces_;
 }
 
 }  // namespace hardware_interface
@@ -0,0 +1,153 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/shared_memory_hardware_server.hpp"
+
+#include <memory>
+#include <string>
+
+#include "rcutils/logging_macros.h"
+
+namespace
+{
+constexpr auto kSharedMemoryServerLoggerName = "shared memory hardware server";
+
+void append_names(
+  std::string & names, char kind, const std::string & name,
+  const std::string & interface_name)
+{
+  names += kind;
+  names += name;
+  names += '\0';
+  names += interface_name;
+  names += '\0';
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+SharedMemoryHardwareServer::SharedMemoryHardwareServer(
+  std::shared_ptr<RobotHardware> hardware,
+  const std::string & segment_name)
+: SharedMemoryHardwareServer(hardware, segment_name, Options())
+{}
+
+SharedMemoryHardwareServer::SharedMemoryHardwareServer(
+  std::shared_ptr<RobotHardware> hardware,
+  const std::string & segment_name,
+  const Options & options)
+: hardware_(hardware), segment_name_(segment_name), options_(options)
+{
+  THROW_ON_NULLPTR(hardware_)
+}
+
+return_type SharedMemoryHardwareServer::init()
+{
+  std::string names;
+  for (const auto & handle : hardware_->get_registered_joints()) {
+    append_names(names, 'j', handle.get_name(), handle.get_interface_name());
+  }
+  for (const auto & handle : hardware_->get_registered_actuators()) {
+    append_names(names, 'a', handle.get_name(), handle.get_interface_name());
+  }
+  for (const auto & handle : hardware_->get_registered_sensors()) {
+    append_names(names, 's', handle.get_name(), handle.get_interface_name());
+  }
+  for (const auto & handle : hardware_->get_registered_gpios()) {
+    append_names(names, 'g', handle.get_name(), handle.get_interface_name());
+  }
+  bindings_.bind(*hardware_, options_.command_suffix);
+
+  if (segment_.create(
+      segment_name_, static_cast<std::uint32_t>(bindings_.state_count()),
+      static_cast<std::uint32_t>(bindings_.command_count()), names,
+      options_.command_suffix) != return_type::OK)
+  {
+    return return_type::ERROR;
+  }
+  bindings_.copy_commands_to(segment_.commands());
+  publish_states();
+  last_command_sequence_ = 0;
+  running_ = true;
+  segment_.header().magic.store(SharedMemorySegmentHeader::MAGIC, std::memory_order_release);
+  return return_type::OK;
+}
+
+return_type SharedMemoryHardwareServer::run_once()
+{
+  auto & header = segment_.header();
+  auto ret = return_type::OK;
+  header.server_heartbeat_ns.store(shared_memory_clock_ns(), std::memory_order_relaxed);
+
+  if (wait_for_sequence(
+      header.command_sequence, header.command_waiters, last_command_sequence_, options_.spin,
+      options_.timeout) &&
+    read_sequenced_values(
+      header.command_sequence, options_.timeout, [this]() {
+        bindings_.copy_commands_from(segment_.commands());
+      }, last_command_sequence_) == return_type::OK)
+  {
+    if (client_lost_) {
+      client_lost_ = false;
+      RCUTILS_LOG_INFO_NAMED(kSharedMemoryServerLoggerName, "client connected");
+    }
+    ret = hardware_->write();
+  } else {
+    if (!client_lost_) {
+      client_lost_ = true;
+      RCUTILS_LOG_ERROR_NAMED(
+        kSharedMemoryServerLoggerName, "no commands from the client, not writing the hardware!");
+    }
+    ret = return_type::ERROR;
+  }
+
+  // the states are kept up to date even without client, for when it comes back
+  if (hardware_->read() != return_type::OK) {
+    ret = return_type::ERROR;
+  }
+  publish_states();
+  return ret;
+}
+
+void SharedMemoryHardwareServer::run()
+{
+  while (running_) {
+    run_once();
+  }
+}
+
+void SharedMemoryHardwareServer::stop()
+{
+  running_ = false;
+}
+
+bool SharedMemoryHardwareServer::is_client_alive() const
+{
+  return segment_.is_open() &&
+         shared_memory_clock_ns() - segment_.header().client_heartbeat_ns.load() <
+         options_.timeout.count();
+}
+
+void SharedMemoryHardwareServer::publish_states()
+{
+  auto & header = segment_.header();
+  write_sequenced_values(
+    header.state_sequence, header.state_waiters, [this]() {
+      bindings_.copy_states_to(segment_.states(), segment_.samples());
+    });
+  header.server_heartbeat_ns.store(shared_memory_clock_ns(), std::memory_order_relaxed);
+}
+
+}  // namespace hardware_interface
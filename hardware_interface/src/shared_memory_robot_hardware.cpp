@@ -0,0 +1,202 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/shared_memory_robot_hardware.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+
+namespace
+{
+constexpr auto kSharedMemoryRobotHardwareLoggerName = "shared memory robot hardware";
+}
+
+namespace hardware_interface
+{
+
+SharedMemoryRobotHardware::SharedMemoryRobotHardware(const std::string & segment_name)
+: SharedMemoryRobotHardware(segment_name, Options())
+{}
+
+SharedMemoryRobotHardware::SharedMemoryRobotHardware(
+  const std::string & segment_name,
+  const Options & options)
+: segment_name_(segment_name), options_(options)
+{}
+
+return_type SharedMemoryRobotHardware::init()
+{
+  if (segment_.open(segment_name_) != return_type::OK) {
+    return return_type::ERROR;
+  }
+  const auto & header = segment_.header();
+  const std::string command_suffix(
+    header.command_suffix, strnlen(header.command_suffix, sizeof(header.command_suffix)));
+
+  // register the interfaces in the order of the server, so they are bound in the same order
+  const std::string names = segment_.names();
+  size_t position = 0;
+  while (position < names.size()) {
+    const char kind = names[position++];
+    const auto name_end = names.find('\0', position);
+    const auto interface_end = names.find('\0', name_end + 1);
+    if (name_end == std::string::npos || interface_end == std::string::npos) {
+      RCUTILS_LOG_ERROR_NAMED(kSharedMemoryRobotHardwareLoggerName, "malformed interface names!");
+      return return_type::ERROR;
+    }
+    const std::string name = names.substr(position, name_end - position);
+    const std::string interface_name = names.substr(name_end + 1, interface_end - name_end - 1);
+    position = interface_end + 1;
+
+    auto ret = return_type::ERROR;
+    switch (kind) {
+      case 'j':
+        ret = register_joint(name, interface_name);
+        break;
+      case 'a':
+        ret = register_actuator(name, interface_name);
+        break;
+      case 's':
+        ret = register_sensor(name, interface_name);
+        break;
+      case 'g':
+        ret = register_gpio(name, interface_name);
+        break;
+      default:
+        RCUTILS_LOG_ERROR_NAMED(
+          kSharedMemoryRobotHardwareLoggerName, "unknown kind of interface '%c'!", kind);
+        break;
+    }
+    if (ret != return_type::OK) {
+      return ret;
+    }
+  }
+
+  bindings_.bind(*this, command_suffix);
+  if (bindings_.state_count() != header.state_count ||
+    bindings_.command_count() != header.command_count)
+  {
+    RCUTILS_LOG_ERROR_NAMED(
+      kSharedMemoryRobotHardwareLoggerName, "interfaces don't match the segment values!");
+    return return_type::ERROR;
+  }
+  // start from the values the server had when it created the segment
+  bindings_.copy_commands_from(segment_.commands());
+  return return_type::OK;
+}
+
+return_type SharedMemoryRobotHardware::read()
+{
+  if (!is_server_alive() && !remap_replaced_segment()) {
+    if (!server_lost_) {
+      server_lost_ = true;
+      invalidate_states();
+      RCUTILS_LOG_ERROR_NAMED(
+        kSharedMemoryRobotHardwareLoggerName, "hardware server %s is not running!",
+        segment_name_.c_str());
+    }
+    return return_type::ERROR;
+  }
+
+  auto & header = segment_.header();
+  if (!wait_for_sequence(
+      header.state_sequence, header.state_waiters, last_state_sequence_, options_.spin,
+      options_.timeout))
+  {
+    invalidate_states();
+    return return_type::ERROR;
+  }
+  if (read_sequenced_values(
+      header.state_sequence, options_.timeout, [this]() {
+        bindings_.copy_states_from(segment_.states(), segment_.samples());
+      }, last_state_sequence_) != return_type::OK)
+  {
+    // the server stopped in the middle of a write, the states copied may be torn
+    invalidate_states();
+    return return_type::ERROR;
+  }
+  server_lost_ = false;
+  // the samples copied carry the validity the server gave them
+  states_valid_ = true;
+  return return_type::OK;
+}
+
+return_type SharedMemoryRobotHardware::write()
+{
+  auto & header = segment_.header();
+  write_sequenced_values(
+    header.command_sequence, header.command_waiters, [this]() {
+      bindings_.copy_commands_to(segment_.commands());
+    });
+  header.client_heartbeat_ns.store(shared_memory_clock_ns(), std::memory_order_relaxed);
+  return return_type::OK;
+}
+
+bool SharedMemoryRobotHardware::remap_replaced_segment()
+{
+  // only a few system calls per cycle while the server is lost
+  if (!segment_.is_open() || !segment_.is_replaced()) {
+    return false;
+  }
+  SharedMemorySegment segment;
+  if (segment.open(segment_name_) != return_type::OK) {
+    return false;
+  }
+  const auto & header = segment.header();
+  const auto & current_header = segment_.header();
+  if (header.state_count != current_header.state_count ||
+    header.command_count != current_header.command_count ||
+    std::strncmp(
+      header.command_suffix, current_header.command_suffix, sizeof(header.command_suffix)) != 0 ||
+    segment.names() != segment_.names())
+  {
+    if (!replaced_segment_rejected_) {
+      replaced_segment_rejected_ = true;
+      RCUTILS_LOG_ERROR_NAMED(
+        kSharedMemoryRobotHardwareLoggerName,
+        "restarted hardware server %s serves other interfaces, not using it!",
+        segment_name_.c_str());
+    }
+    return false;
+  }
+  segment_.swap(segment);
+  replaced_segment_rejected_ = false;
+  // the sequences of the new segment start over
+  last_state_sequence_ = 0;
+  RCUTILS_LOG_INFO_NAMED(
+    kSharedMemoryRobotHardwareLoggerName, "hardware server %s restarted, segment remapped",
+    segment_name_.c_str());
+  return is_server_alive();
+}
+
+void SharedMemoryRobotHardware::invalidate_states()
+{
+  // controllers checking the samples stop trusting the last states received
+  if (states_valid_) {
+    states_valid_ = false;
+    bindings_.set_states_valid(false);
+  }
+}
+
+bool SharedMemoryRobotHardware::is_server_alive() const
+{
+  return segment_.is_open() &&
+         shared_memory_clock_ns() - segment_.header().server_heartbeat_ns.load() <
+         options_.timeout.count();
+}
+
+}  // namespace hardware_interface
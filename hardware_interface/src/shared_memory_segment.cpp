@@ -0,0 +1,441 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hardware_interface/shared_memory_segment.hpp"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+
+namespace
+{
+constexpr auto kSharedMemoryLoggerName = "shared memory segment";
+
+static_assert(
+  sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t) && ATOMIC_INT_LOCK_FREE == 2,
+  "futex words must be plain lock-free 32 bits integers");
+static_assert(
+  ATOMIC_LLONG_LOCK_FREE == 2,
+  "atomics shared between processes must be lock-free");
+
+constexpr size_t kValuesAlignment = 64;
+
+size_t values_offset()
+{
+  return (sizeof(hardware_interface::SharedMemorySegmentHeader) + kValuesAlignment - 1) /
+         kValuesAlignment * kValuesAlignment;
+}
+
+size_t segment_size(std::uint32_t state_count, std::uint32_t command_count, size_t names_size)
+{
+  return values_offset() + (state_count + command_count) * sizeof(double) +
+         state_count * sizeof(hardware_interface::InterfaceSample) + names_size;
+}
+
+std::string shm_name(const std::string & name)
+{
+  return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+bool ends_with(const std::string & value, const std::string & suffix)
+{
+  return value.size() >= suffix.size() &&
+         value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// keep the segment in RAM, a page fault in the control loop would cost more than the cycle
+void lock_in_memory(void * data, size_t size, const std::string & name)
+{
+  if (mlock(data, size) != 0) {
+    RCUTILS_LOG_WARN_NAMED(
+      kSharedMemoryLoggerName, "cannot lock segment %s in memory, page faults may delay the "
+      "control loop: %s", name.c_str(), strerror(errno));
+  }
+}
+
+template<typename HandleType>
+void bind_handles(
+  std::vector<HandleType> && handles, const std::string & command_suffix,
+  hardware_interface::SharedMemoryHandles<HandleType> & bound)
+{
+  bound.states.clear();
+  bound.commands.clear();
+  for (auto & handle : handles) {
+    auto & bound_handles = ends_with(handle.get_interface_name(), command_suffix) ?
+      bound.commands : bound.states;
+    bound_handles.push_back(handle);
+  }
+}
+
+template<typename HandleType>
+double * copy_to(const std::vector<HandleType> & handles, double * values)
+{
+  for (const auto & handle : handles) {
+    *values++ = handle.get_value();
+  }
+  return values;
+}
+
+template<typename HandleType>
+const double * copy_from(std::vector<HandleType> & handles, const double * values)
+{
+  for (auto & handle : handles) {
+    handle.set_value(*values++);
+  }
+  return values;
+}
+
+template<typename HandleType>
+hardware_interface::InterfaceSample * copy_samples_to(
+  const std::vector<HandleType> & handles, hardware_interface::InterfaceSample * samples)
+{
+  for (const auto & handle : handles) {
+    *samples++ = handle.get_sample();
+  }
+  return samples;
+}
+
+template<typename HandleType>
+const hardware_interface::InterfaceSample * copy_samples_from(
+  std::vector<HandleType> & handles, const hardware_interface::InterfaceSample * samples)
+{
+  for (auto & handle : handles) {
+    handle.set_sample(samples->time, samples->valid);
+    ++samples;
+  }
+  return samples;
+}
+
+template<typename HandleType>
+void set_valid(std::vector<HandleType> & handles, bool valid)
+{
+  for (auto & handle : handles) {
+    handle.set_sample(handle.get_sample().time, valid);
+  }
+}
+}  // namespace
+
+namespace hardware_interface
+{
+
+void SharedMemoryBindings::bind(RobotHardware & hardware, const std::string & command_suffix)
+{
+  bind_handles(hardware.get_registered_joints(), command_suffix, joints);
+  bind_handles(hardware.get_registered_actuators(), command_suffix, actuators);
+  bind_handles(hardware.get_registered_sensors(), command_suffix, sensors);
+  bind_handles(hardware.get_registered_gpios(), command_suffix, gpios);
+}
+
+size_t SharedMemoryBindings::state_count() const
+{
+  return joints.states.size() + actuators.states.size() + sensors.states.size() +
+         gpios.states.size();
+}
+
+size_t SharedMemoryBindings::command_count() const
+{
+  return joints.commands.size() + actuators.commands.size() + sensors.commands.size() +
+         gpios.commands.size();
+}
+
+void SharedMemoryBindings::copy_states_to(double * values, InterfaceSample * samples) const
+{
+  values = copy_to(joints.states, values);
+  values = copy_to(actuators.states, values);
+  values = copy_to(sensors.states, values);
+  copy_to(gpios.states, values);
+  samples = copy_samples_to(joints.states, samples);
+  samples = copy_samples_to(actuators.states, samples);
+  samples = copy_samples_to(sensors.states, samples);
+  copy_samples_to(gpios.states, samples);
+}
+
+void SharedMemoryBindings::copy_states_from(
+  const double * values, const InterfaceSample * samples)
+{
+  values = copy_from(joints.states, values);
+  values = copy_from(actuators.states, values);
+  values = copy_from(sensors.states, values);
+  copy_from(gpios.states, values);
+  samples = copy_samples_from(joints.states, samples);
+  samples = copy_samples_from(actuators.states, samples);
+  samples = copy_samples_from(sensors.states, samples);
+  copy_samples_from(gpios.states, samples);
+}
+
+void SharedMemoryBindings::copy_commands_to(double * values) const
+{
+  values = copy_to(joints.commands, values);
+  values = copy_to(actuators.commands, values);
+  values = copy_to(sensors.commands, values);
+  copy_to(gpios.commands, values);
+}
+
+void SharedMemoryBindings::copy_commands_from(const double * values)
+{
+  values = copy_from(joints.commands, values);
+  values = copy_from(actuators.commands, values);
+  values = copy_from(sensors.commands, values);
+  copy_from(gpios.commands, values);
+}
+
+void SharedMemoryBindings::set_states_valid(bool valid)
+{
+  set_valid(joints.states, valid);
+  set_valid(actuators.states, valid);
+  set_valid(sensors.states, valid);
+  set_valid(gpios.states, valid);
+}
+
+SharedMemorySegment::~SharedMemorySegment()
+{
+  close();
+}
+
+return_type SharedMemorySegment::create(
+  const std::string & name, std::uint32_t state_count, std::uint32_t command_count,
+  const std::string & names, const std::string & command_suffix)
+{
+  close();
+  if (command_suffix.size() >= sizeof(SharedMemorySegmentHeader::command_suffix)) {
+    RCUTILS_LOG_ERROR_NAMED(kSharedMemoryLoggerName, "command suffix is too long!");
+    return return_type::ERROR;
+  }
+
+  name_ = shm_name(name);
+  shm_unlink(name_.c_str());
+  const int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    RCUTILS_LOG_ERROR_NAMED(
+      kSharedMemoryLoggerName, "cannot create segment %s: %s", name_.c_str(), strerror(errno));
+    return return_type::ERROR;
+  }
+  const size_t size = segment_size(state_count, command_count, names.size());
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    RCUTILS_LOG_ERROR_NAMED(
+      kSharedMemoryLoggerName, "cannot size segment %s: %s", name_.c_str(), strerror(errno));
+    ::close(fd);
+    shm_unlink(name_.c_str());
+    return return_type::ERROR;
+  }
+  struct stat segment_stat;
+  const std::uint64_t inode =
+    fstat(fd, &segment_stat) == 0 ? static_cast<std::uint64_t>(segment_stat.st_ino) : 0;
+  void * data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    RCUTILS_LOG_ERROR_NAMED(
+      kSharedMemoryLoggerName, "cannot map segment %s: %s", name_.c_str(), strerror(errno));
+    shm_unlink(name_.c_str());
+    return return_type::ERROR;
+  }
+  lock_in_memory(data, size, name_);
+
+  data_ = data;
+  size_ = size;
+  owner_ = true;
+  inode_ = inode;
+  auto header_ptr = new (data_) SharedMemorySegmentHeader();
+  header_ptr->magic.store(0, std::memory_order_relaxed);
+  header_ptr->version = SharedMemorySegmentHeader::VERSION;
+  header_ptr->size = size;
+  header_ptr->state_count = state_count;
+  header_ptr->command_count = command_count;
+  header_ptr->names_size = static_cast<std::uint32_t>(names.size());
+  std::memset(header_ptr->command_suffix, 0, sizeof(header_ptr->command_suffix));
+  std::memcpy(header_ptr->command_suffix, command_suffix.data(), command_suffix.size());
+  header_ptr->state_sequence.store(0, std::memory_order_relaxed);
+  header_ptr->state_waiters.store(0, std::memory_order_relaxed);
+  header_ptr->command_sequence.store(0, std::memory_order_relaxed);
+  header_ptr->command_waiters.store(0, std::memory_order_relaxed);
+  header_ptr->server_heartbeat_ns.store(shared_memory_clock_ns(), std::memory_order_relaxed);
+  header_ptr->client_heartbeat_ns.store(0, std::memory_order_relaxed);
+  for (std::uint32_t i = 0; i < state_count; ++i) {
+    new (samples() + i) InterfaceSample();
+  }
+  std::memcpy(samples() + state_count, names.data(), names.size());
+  return return_type::OK;
+}
+
+return_type SharedMemorySegment::open(const std::string & name)
+{
+  close();
+  name_ = shm_name(name);
+  const int fd = shm_open(name_.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    RCUTILS_LOG_ERROR_NAMED(
+      kSharedMemoryLoggerName, "cannot open segment %s: %s", name_.c_str(), strerror(errno));
+    return return_type::ERROR;
+  }
+  struct stat segment_stat;
+  if (fstat(fd, &segment_stat) != 0 ||
+    static_cast<size_t>(segment_stat.st_size) < sizeof(SharedMemorySegmentHeader))
+  {
+    RCUTILS_LOG_ERROR_NAMED(kSharedMemoryLoggerName, "segment %s is not ready", name_.c_str());
+    ::close(fd);
+    return return_type::ERROR;
+  }
+  const size_t size = static_cast<size_t>(segment_stat.st_size);
+  void * data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    RCUTILS_LOG_ERROR_NAMED(
+      kSharedMemoryLoggerName, "cannot map segment %s: %s", name_.c_str(), strerror(errno));
+    return return_type::ERROR;
+  }
+  lock_in_memory(data, size, name_);
+  data_ = data;
+  size_ = size;
+  owner_ = false;
+  inode_ = static_cast<std::uint64_t>(segment_stat.st_ino);
+
+  const auto & header_ref = header();
+  if (header_ref.magic.load(std::memory_order_acquire) != SharedMemorySegmentHeader::MAGIC ||
+    header_ref.version != SharedMemorySegmentHeader::VERSION || header_ref.size != size)
+  {
+    RCUTILS_LOG_ERROR_NAMED(
+      kSharedMemoryLoggerName, "segment %s is not ready or of another version", name_.c_str());
+    close();
+    return return_type::ERROR;
+  }
+  return return_type::OK;
+}
+
+void SharedMemorySegment::close()
+{
+  if (data_) {
+    munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+  if (owner_) {
+    shm_unlink(name_.c_str());
+    owner_ = false;
+  }
+}
+
+bool SharedMemorySegment::is_open() const
+{
+  return data_ != nullptr;
+}
+
+bool SharedMemorySegment::is_replaced() const
+{
+  const int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat segment_stat;
+  const bool replaced = fstat(fd, &segment_stat) == 0 &&
+    static_cast<std::uint64_t>(segment_stat.st_ino) != inode_;
+  ::close(fd);
+  return replaced;
+}
+
+void SharedMemorySegment::swap(SharedMemorySegment & other)
+{
+  std::swap(name_, other.name_);
+  std::swap(data_, other.data_);
+  std::swap(size_, other.size_);
+  std::swap(owner_, other.owner_);
+  std::swap(inode_, other.inode_);
+}
+
+SharedMemorySegmentHeader & SharedMemorySegment::header() const
+{
+  return *static_cast<SharedMemorySegmentHeader *>(data_);
+}
+
+double * SharedMemorySegment::states() const
+{
+  return reinterpret_cast<double *>(static_cast<char *>(data_) + values_offset());
+}
+
+double * SharedMemorySegment::commands() const
+{
+  return states() + header().state_count;
+}
+
+InterfaceSample * SharedMemorySegment::samples() const
+{
+  return reinterpret_cast<InterfaceSample *>(commands() + header().command_count);
+}
+
+std::string SharedMemorySegment::names() const
+{
+  const auto names_begin = reinterpret_cast<const char *>(samples() + header().state_count);
+  return std::string(names_begin, header().names_size);
+}
+
+std::int64_t shared_memory_clock_ns()
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<std::int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+bool wait_for_sequence(
+  std::atomic<std::uint32_t> & sequence, std::atomic<std::uint32_t> & waiters,
+  std::uint32_t last, std::chrono::nanoseconds spin, std::chrono::nanoseconds timeout)
+{
+  const std::int64_t start_ns = shared_memory_clock_ns();
+  const std::int64_t spin_end_ns = start_ns + spin.count();
+  const std::int64_t deadline_ns = start_ns + timeout.count();
+  while (true) {
+    const std::uint32_t current = sequence.load(std::memory_order_acquire);
+    if (current != last && !(current & 1)) {
+      return true;
+    }
+    const std::int64_t now_ns = shared_memory_clock_ns();
+    if (now_ns >= deadline_ns) {
+      return false;
+    }
+    if (now_ns < spin_end_ns) {
+      continue;
+    }
+    // sleeps until the value changes, the timeout expires or a signal arrives, the futex
+    // refusing to sleep if the writer changed the value since the count was raised
+    const std::int64_t remaining_ns = deadline_ns - now_ns;
+    timespec remaining;
+    remaining.tv_sec = static_cast<time_t>(remaining_ns / 1000000000);
+    remaining.tv_nsec = static_cast<long>(remaining_ns % 1000000000);  // NOLINT
+    waiters.fetch_add(1, std::memory_order_seq_cst);
+    syscall(
+      SYS_futex, reinterpret_cast<std::uint32_t *>(&sequence), FUTEX_WAIT, current, &remaining,
+      nullptr, 0);
+    waiters.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+void wake_sequence_waiters(std::atomic<std::uint32_t> & sequence)
+{
+  syscall(
+    SYS_futex, reinterpret_cast<std::uint32_t *>(&sequence), FUTEX_WAKE, INT_MAX, nullptr,
+    nullptr, 0);
+}
+
+}  // namespace hardware_interface
@@ -0,0 +1,130 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include "hardware_interface/robot_hardware.hpp"
+
+namespace hw = hardware_interface;
+
+namespace
+{
+constexpr auto JOINT_NAME = "joint_1";
+constexpr auto ACTUATOR_NAME = "actuator_1";
+constexpr auto COMMAND_INTERFACE = "velocity_command";
+
+class DummyRobotHardware : public hw::RobotHardware
+{
+  hw::return_type init() override
+  {
+    return hw::return_type::OK;
+  }
+
+  hw::return_type read() override
+  {
+    return hw::return_type::OK;
+  }
+
+  hw::return_type write() override
+  {
+    return hw::return_type::OK;
+  }
+};
+}  // namespace
+
+class TestCommandWatchdog : public testing::Test
+{
+protected:
+  void SetUp()
+  {
+    ASSERT_EQ(hw::return_type::OK, hardware_.register_joint(JOINT_NAME, COMMAND_INTERFACE, 1.0));
+    ASSERT_EQ(
+      hw::return_type::OK, hardware_.register_actuator(ACTUATOR_NAME, COMMAND_INTERFACE, 1.0));
+    ASSERT_EQ(hw::return_type::OK, hardware_.get_joint_handle(joint_command_));
+    ASSERT_EQ(hw::return_type::OK, hardware_.get_actuator_handle(actuator_command_));
+  }
+
+  DummyRobotHardware hardware_;
+  hw::JointHandle joint_command_{JOINT_NAME, COMMAND_INTERFACE};
+  hw::ActuatorHandle actuator_command_{ACTUATOR_NAME, COMMAND_INTERFACE};
+};
+
+TEST_F(TestCommandWatchdog, counts_writes_through_any_handle)
+{
+  ASSERT_TRUE(joint_command_.has_write_sequence());
+  EXPECT_EQ(0u, joint_command_.get_write_sequence());
+  joint_command_.set_value(2.0);
+  hw::JointHandle other_handle(JOINT_NAME, COMMAND_INTERFACE);
+  hardware_.get_joint_handle(other_handle);
+  other_handle.set_value(3.0);
+  EXPECT_EQ(2u, joint_command_.get_write_sequence());
+
+  const auto registered_joints = hardware_.get_registered_joints();
+  ASSERT_EQ(1u, registered_joints.size());
+  EXPECT_EQ(2u, registered_joints[0].get_write_sequence());
+
+  hw::JointHandle unbound(JOINT_NAME, COMMAND_INTERFACE);
+  EXPECT_FALSE(unbound.has_write_sequence());
+}
+
+TEST_F(TestCommandWatchdog, applies_safe_value_to_stale_commands)
+{
+  ASSERT_EQ(
+    hw::return_type::OK, hardware_.watch_joint_command(JOINT_NAME, COMMAND_INTERFACE, 0.0, 1));
+  ASSERT_EQ(
+    hw::return_type::OK,
+    hardware_.watch_actuator_command(ACTUATOR_NAME, COMMAND_INTERFACE, -1.0));
+
+  // the joint command may miss one cycle, the actuator command none
+  EXPECT_EQ(1u, hardware_.enforce_command_watchdog());
+  EXPECT_DOUBLE_EQ(1.0, joint_command_.get_value());
+  EXPECT_DOUBLE_EQ(-1.0, actuator_command_.get_value());
+
+  EXPECT_EQ(2u, hardware_.enforce_command_watchdog());
+  EXPECT_DOUBLE_EQ(0.0, joint_command_.get_value());
+
+  // fresh commands are left untouched
+  joint_command_.set_value(2.0);
+  actuator_command_.set_value(3.0);
+  EXPECT_EQ(0u, hardware_.enforce_command_watchdog());
+  EXPECT_DOUBLE_EQ(2.0, joint_command_.get_value());
+  EXPECT_DOUBLE_EQ(3.0, actuator_command_.get_value());
+
+  for (auto cycle = 0; cycle < 1000; ++cycle) {
+    joint_command_.set_value(cycle);
+    EXPECT_EQ(1u, hardware_.enforce_command_watchdog());
+  }
+  EXPECT_DOUBLE_EQ(999.0, joint_command_.get_value());
+  EXPECT_DOUBLE_EQ(-1.0, actuator_command_.get_value());
+}
+
+TEST_F(TestCommandWatchdog, refuses_unknown_commands)
+{
+  EXPECT_EQ(
+    hw::return_type::ERROR, hardware_.watch_joint_command("unknown", COMMAND_INTERFACE, 0.0));
+  EXPECT_EQ(
+    hw::return_type::ERROR, hardware_.watch_actuator_command(ACTUATOR_NAME, "unknown", 0.0));
+  EXPECT_EQ(0u, hardware_.enforce_command_watchdog());
+}
+
+TEST(TestCommandWatchdogRegistration, watching_freezes_the_registration)
+{
+  DummyRobotHardware hardware;
+  ASSERT_EQ(hw::return_type::OK, hardware.register_joint(JOINT_NAME, COMMAND_INTERFACE));
+  ASSERT_EQ(
+    hw::return_type::OK, hardware.watch_joint_command(JOINT_NAME, COMMAND_INTERFACE, 0.0));
+  EXPECT_TRUE(hardware.is_registration_frozen());
+  // registering could move the command the watchdog writes
+  EXPECT_EQ(hw::return_type::ERROR, hardware.register_joint("joint_2", COMMAND_INTERFACE));
+}
@@ -0,0 +1,174 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hardware_interface/gpio_handle.hpp"
+#include "hardware_interface/interface_registry.hpp"
+#include "hardware_interface/joint_handle.hpp"
+#include "hardware_interface/sensor_handle.hpp"
+
+namespace hw = hardware_interface;
+using hw::InterfaceNamespace;
+using testing::ElementsAre;
+using testing::IsEmpty;
+using testing::SizeIs;
+
+TEST(TestInterfaceRegistry, names_are_unique_per_namespace)
+{
+  hw::InterfaceRegistry registry;
+  ASSERT_EQ(
+    hw::return_type::OK,
+    registry.register_interface(InterfaceNamespace::JOINT, "arm", "position", 1.0));
+  ASSERT_EQ(
+    hw::return_type::OK,
+    registry.register_interface(InterfaceNamespace::SENSOR, "arm", "position", 2.0));
+  EXPECT_EQ(
+    hw::return_type::ERROR,
+    registry.register_interface(InterfaceNamespace::SENSOR, "arm", "position"));
+
+  EXPECT_THAT(registry.get_names(InterfaceNamespace::JOINT), ElementsAre("arm"));
+  EXPECT_THAT(registry.get_names(InterfaceNamespace::SENSOR), ElementsAre("arm"));
+  EXPECT_THAT(registry.get_names(InterfaceNamespace::GPIO), IsEmpty());
+  EXPECT_EQ(0u, registry.find(InterfaceNamespace::JOINT, "arm", "position"));
+  EXPECT_EQ(1u, registry.find(InterfaceNamespace::SENSOR, "arm", "position"));
+  EXPECT_EQ(
+    hw::InterfaceRegistry::npos, registry.find(InterfaceNamespace::GPIO, "arm", "position"));
+  EXPECT_ANY_THROW(registry.get_interface_names(InterfaceNamespace::GPIO, "arm"));
+}
+
+TEST(TestInterfaceRegistry, values_of_all_namespaces_are_contiguous)
+{
+  hw::InterfaceRegistry registry;
+  ASSERT_EQ(
+    hw::return_type::OK, registry.register_interfaces(
+      InterfaceNamespace::JOINT, {{"joint_1", "position", 1.0}, {"joint_1", "velocity", 2.0}}));
+  ASSERT_EQ(
+    hw::return_type::OK,
+    registry.register_interface(InterfaceNamespace::SENSOR, "ft_sensor", "force_z", 3.0));
+  ASSERT_EQ(
+    hw::return_type::OK,
+    registry.register_interface(InterfaceNamespace::GPIO, "gripper", "closed", 4.0));
+  registry.freeze();
+  EXPECT_EQ(
+    hw::return_type::ERROR,
+    registry.register_interface(InterfaceNamespace::GPIO, "gripper", "open"));
+
+  hw::SensorHandle force{"ft_sensor", "force_z"};
+  hw::GpioHandle closed{"gripper", "closed"};
+  ASSERT_EQ(hw::return_type::OK, registry.get_handle(InterfaceNamespace::SENSOR, force));
+  ASSERT_EQ(hw::return_type::OK, registry.get_handle(InterfaceNamespace::GPIO, closed));
+  EXPECT_EQ(hw::return_type::ERROR, registry.get_handle(InterfaceNamespace::JOINT, closed));
+  force.set_value(30.0);
+  closed.set_value(0.0);
+
+  // a snapshot of the whole state is a single copy
+  ASSERT_EQ(4u, registry.size());
+  std::vector<double> snapshot(registry.size());
+  std::memcpy(snapshot.data(), registry.data(), registry.size() * sizeof(double));
+  EXPECT_THAT(snapshot, ElementsAre(1.0, 2.0, 30.0, 0.0));
+  EXPECT_EQ(1u, registry.write_sequences()[2].load());
+}
+
+TEST(TestInterfaceRegistry, handles_are_listed_component_by_component)
+{
+  hw::InterfaceRegistry registry;
+  registry.register_interface(InterfaceNamespace::JOINT, "joint_1", "position");
+  registry.register_interface(InterfaceNamespace::JOINT, "joint_2", "position");
+  registry.register_interface(InterfaceNamespace::JOINT, "joint_1", "velocity");
+
+  const auto handles = registry.get_handles<hw::JointHandle>(InterfaceNamespace::JOINT);
+  ASSERT_EQ(3u, handles.size());
+  EXPECT_EQ("joint_1", handles[1].get_name());
+  EXPECT_EQ("velocity", handles[1].get_interface_name());
+  registry.data()[2] = 5.0;
+  EXPECT_EQ(5.0, handles[1].get_value());
+}
+
+TEST(TestInterfaceRegistry, handing_out_handles_freezes_the_registration)
+{
+  hw::InterfaceRegistry registry;
+  ASSERT_EQ(
+    hw::return_type::OK,
+    registry.register_interface(InterfaceNamespace::JOINT, "joint_1", "position", 1.0));
+  hw::JointHandle missing{"joint_2", "position"};
+  EXPECT_EQ(hw::return_type::ERROR, registry.get_handle(InterfaceNamespace::JOINT, missing));
+  EXPECT_FALSE(registry.is_frozen());
+
+  hw::JointHandle position{"joint_1", "position"};
+  ASSERT_EQ(hw::return_type::OK, registry.get_handle(InterfaceNamespace::JOINT, position));
+  EXPECT_TRUE(registry.is_frozen());
+  // registering could move the value the handle points to
+  EXPECT_EQ(
+    hw::return_type::ERROR,
+    registry.register_interface(InterfaceNamespace::JOINT, "joint_2", "position"));
+  EXPECT_EQ(1.0, position.get_value());
+
+  hw::InterfaceRegistry listed;
+  ASSERT_EQ(
+    hw::return_type::OK,
+    listed.register_interface(InterfaceNamespace::SENSOR, "ft_sensor", "force_z"));
+  EXPECT_THAT(listed.get_handles<hw::SensorHandle>(InterfaceNamespace::SENSOR), SizeIs(1));
+  EXPECT_TRUE(listed.is_frozen());
+}
+
+TEST(TestInterfaceRegistry, snapshots_are_consistent)
+{
+  hw::InterfaceRegistry registry;
+  ASSERT_EQ(
+    hw::return_type::OK, registry.register_interfaces(
+      InterfaceNamespace::JOINT, {{"joint_1", "position"}, {"joint_1", "velocity"}}));
+  std::vector<double> snapshot;
+  registry.take_snapshot();
+  EXPECT_EQ(nullptr, registry.get_snapshot());
+  EXPECT_FALSE(registry.read_snapshot(snapshot));
+
+  registry.enable_snapshot();
+  EXPECT_TRUE(registry.has_snapshot());
+  EXPECT_TRUE(registry.is_frozen());
+  registry.data()[0] = 1.0;
+  registry.take_snapshot();
+  // controllers writing the values don't change the state read by the next ones
+  registry.data()[0] = 2.0;
+  EXPECT_EQ(1.0, registry.get_snapshot()[0]);
+  ASSERT_TRUE(registry.read_snapshot(snapshot));
+  EXPECT_THAT(snapshot, ElementsAre(1.0, 0.0));
+
+  // a reader never sees values of different cycles
+  registry.data()[1] = 2.0;
+  registry.take_snapshot();
+  std::atomic<bool> running{true};
+  std::thread control_loop([&]() {
+      for (double cycle = 0.0; running; ++cycle) {
+        registry.data()[0] = cycle;
+        registry.data()[1] = cycle;
+        registry.take_snapshot();
+      }
+    });
+  int torn_reads = 0;
+  for (int i = 0; i < 10000; ++i) {
+    if (registry.read_snapshot(snapshot) && snapshot[0] != snapshot[1]) {
+      ++torn_reads;
+    }
+  }
+  running = false;
+  control_loop.join();
+  EXPECT_EQ(0, torn_reads);
+}
@@ -73,3 +73,18 @@ TEST(TestJointHandle, with_value_ptr_initializes_new_handle_correctly)
   EXPECT_ANY_THROW(handle.get_value());
   EXPECT_DOUBLE_EQ(new_handle.get_value(), value);
 }
+
+TEST(TestJointHandle, set_value_counts_writes)
+{
+  double value = 1.337;
+  hardware_interface::WriteSequence write_sequence;
+  JointHandle handle{JOINT_NAME, FOO_INTERFACE};
+  auto new_handle = handle.with_value_ptr(&value, &write_sequence);
+  EXPECT_FALSE(handle.has_write_sequence());
+  EXPECT_ANY_THROW(handle.get_write_sequence());
+  ASSERT_TRUE(new_handle.has_write_sequence());
+  new_handle.set_value(0.0);
+  new_handle.set_value(1.0);
+  EXPECT_EQ(new_handle.get_write_sequence(), 2u);
+  EXPECT_EQ(write_sequence.load(), 2u);
+}
@@ -108,12 +108,6 @@ TEST_F(TestActuators, can_get_registered_actuators)
 {
   EXPECT_EQ(hw::return_type::OK, robot_hw_.register_actuator(ACTUATOR_NAME, FOO_INTERFACE));
   EXPECT_THAT(robot_hw_.get_registered_actuator_names(), ElementsAre(ACTUATOR_NAME));
-  const auto registered_actuators = robot_hw_.get_registered_actuators();
-  EXPECT_THAT(registered_actuators, SizeIs(1));
-  const auto & actuator_handle = registered_actuators[0];
-  EXPECT_EQ(actuator_handle.get_name(), ACTUATOR_NAME);
-  EXPECT_EQ(actuator_handle.get_interface_name(), FOO_INTERFACE);
-
   EXPECT_EQ(hw::return_type::OK, robot_hw_.register_actuator(ACTUATOR_NAME, BAR_INTERFACE));
   EXPECT_THAT(robot_hw_.get_registered_actuator_names(), ElementsAre(ACTUATOR_NAME));
 
@@ -128,6 +122,12 @@ TEST_F(TestActuators, can_get_registered_actuators)
     robot_hw_.get_registered_actuator_interface_names(ACTUATOR2_NAME),
     UnorderedElementsAre(FOO_INTERFACE));
 
+  const auto registered_actuators = robot_hw_.get_registered_actuators();
+  EXPECT_THAT(registered_actuators, SizeIs(3));
+  const auto & actuator_handle = registered_actuators[0];
+  EXPECT_EQ(actuator_handle.get_name(), ACTUATOR_NAME);
+  EXPECT_EQ(actuator_handle.get_interface_name(), FOO_INTERFACE);
+
   std::vector<hw::ActuatorHandle> handles =
   {{ACTUATOR_NAME, FOO_INTERFACE}, {ACTUATOR_NAME, BAR_INTERFACE},
     {ACTUATOR2_NAME, FOO_INTERFACE}};
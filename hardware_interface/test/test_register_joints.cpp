@@ -108,12 +108,6 @@ TEST_F(TestJoints, can_get_registered_joints)
 {
   EXPECT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, FOO_INTERFACE));
   EXPECT_THAT(robot_hw_.get_registered_joint_names(), ElementsAre(JOINT_NAME));
-  const auto registered_jointss = robot_hw_.get_registered_joints();
-  EXPECT_THAT(registered_jointss, SizeIs(1));
-  const auto & joints_handle = registered_jointss[0];
-  EXPECT_EQ(joints_handle.get_name(), JOINT_NAME);
-  EXPECT_EQ(joints_handle.get_interface_name(), FOO_INTERFACE);
-
   EXPECT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, BAR_INTERFACE));
   EXPECT_THAT(robot_hw_.get_registered_joint_names(), ElementsAre(JOINT_NAME));
 
@@ -128,6 +122,12 @@ TEST_F(TestJoints, can_get_registered_joints)
     robot_hw_.get_registered_joint_interface_names(JOINT2_NAME),
     UnorderedElementsAre(FOO_INTERFACE));
 
+  const auto registered_jointss = robot_hw_.get_registered_joints();
+  EXPECT_THAT(registered_jointss, SizeIs(3));
+  const auto & joints_handle = registered_jointss[0];
+  EXPECT_EQ(joints_handle.get_name(), JOINT_NAME);
+  EXPECT_EQ(joints_handle.get_interface_name(), FOO_INTERFACE);
+
   std::vector<hw::JointHandle> handles =
   {{JOINT_NAME, FOO_INTERFACE}, {JOINT_NAME, BAR_INTERFACE},
     {JOINT2_NAME, FOO_INTERFACE}};
@@ -189,3 +189,91 @@ TEST_F(TestJoints, can_get_registered_joints_of_interface)
   ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handles(handles3, "NoInterface"));
   ASSERT_TRUE(handles3.empty());
 }
+
+TEST_F(TestJoints, samples_are_shared_by_handles_of_an_interface)
+{
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, FOO_INTERFACE));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, BAR_INTERFACE));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT2_NAME, FOO_INTERFACE));
+
+  hw::JointHandle foo_handle{JOINT_NAME, FOO_INTERFACE};
+  hw::JointHandle bar_handle{JOINT_NAME, BAR_INTERFACE};
+  hw::JointHandle joint2_handle{JOINT2_NAME, FOO_INTERFACE};
+  EXPECT_FALSE(foo_handle.has_sample());
+  EXPECT_ANY_THROW(foo_handle.get_sample());
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handle(foo_handle));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handle(bar_handle));
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handle(joint2_handle));
+  ASSERT_TRUE(foo_handle.has_sample());
+  EXPECT_EQ(0, foo_handle.get_sample().time);
+  EXPECT_TRUE(foo_handle.get_sample().valid);
+
+  // stamped one interface at a time
+  foo_handle.set_sample(42, false);
+  EXPECT_EQ(42, robot_hw_.get_registered_joints()[0].get_sample().time);
+  EXPECT_FALSE(robot_hw_.get_registered_joints()[0].get_sample().valid);
+  EXPECT_EQ(0, bar_handle.get_sample().time);
+
+  // or a whole joint at once
+  hw::InterfaceSample sample;
+  sample.time = 1337;
+  EXPECT_EQ(hw::return_type::OK, robot_hw_.set_joint_sample(JOINT_NAME, sample));
+  EXPECT_EQ(1337, foo_handle.get_sample().time);
+  EXPECT_TRUE(foo_handle.get_sample().valid);
+  EXPECT_EQ(1337, bar_handle.get_sample().time);
+  EXPECT_EQ(0, joint2_handle.get_sample().time);
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.set_joint_sample("no_joint", sample));
+}
+
+TEST_F(TestJoints, can_register_joints_in_bulk)
+{
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, FOO_INTERFACE));
+  ASSERT_EQ(
+    hw::return_type::OK, robot_hw_.register_joints(
+      {{JOINT_NAME, BAR_INTERFACE, 1.0}, {JOINT2_NAME, FOO_INTERFACE, 2.0},
+        {JOINT2_NAME, BAR_INTERFACE, 3.0}}));
+  EXPECT_THAT(robot_hw_.get_registered_joint_names(), ElementsAre(JOINT_NAME, JOINT2_NAME));
+  EXPECT_THAT(
+    robot_hw_.get_registered_joint_interface_names(JOINT2_NAME),
+    ElementsAre(FOO_INTERFACE, BAR_INTERFACE));
+
+  hw::JointHandle handle{JOINT2_NAME, BAR_INTERFACE};
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.get_joint_handle(handle));
+  EXPECT_DOUBLE_EQ(3.0, handle.get_value());
+  ASSERT_TRUE(handle.has_write_sequence());
+  ASSERT_TRUE(handle.has_sample());
+}
+
+TEST_F(TestJoints, bulk_registration_is_all_or_nothing)
+{
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, FOO_INTERFACE));
+  // already registered
+  EXPECT_EQ(
+    hw::return_type::ERROR, robot_hw_.register_joints(
+      {{JOINT2_NAME, FOO_INTERFACE, 0.0}, {JOINT_NAME, FOO_INTERFACE, 0.0}}));
+  // twice in the same table
+  EXPECT_EQ(
+    hw::return_type::ERROR, robot_hw_.register_joints(
+      {{JOINT2_NAME, FOO_INTERFACE, 0.0}, {JOINT2_NAME, FOO_INTERFACE, 0.0}}));
+  EXPECT_EQ(
+    hw::return_type::ERROR, robot_hw_.register_joints({{JOINT2_NAME, "", 0.0}}));
+  EXPECT_THAT(robot_hw_.get_registered_joint_names(), ElementsAre(JOINT_NAME));
+  EXPECT_THAT(
+    robot_hw_.get_registered_joint_interface_names(JOINT_NAME), ElementsAre(FOO_INTERFACE));
+}
+
+TEST_F(TestJoints, can_not_register_joints_once_frozen)
+{
+  ASSERT_EQ(hw::return_type::OK, robot_hw_.register_joint(JOINT_NAME, FOO_INTERFACE));
+  EXPECT_FALSE(robot_hw_.is_registration_frozen());
+  robot_hw_.freeze_registration();
+  EXPECT_TRUE(robot_hw_.is_registration_frozen());
+
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.register_joint(JOINT_NAME, BAR_INTERFACE));
+  EXPECT_EQ(
+    hw::return_type::ERROR, robot_hw_.register_joints({{JOINT2_NAME, FOO_INTERFACE, 0.0}}));
+  EXPECT_EQ(hw::return_type::ERROR, robot_hw_.register_actuator(JOINT2_NAME, FOO_INTERFACE));
+
+  hw::JointHandle handle{JOINT_NAME, FOO_INTERFACE};
+  EXPECT_EQ(hw::return_type::OK, robot_hw_.get_joint_handle(handle));
+}
@@ -141,3 +141,18 @@ TEST_F(TestRobotHardwareInterface, can_get_handles_by_name)
   op_mode_handle = nullptr;
   EXPECT_EQ(hw::return_type::OK, robot_.get_operation_mode_handle(NEW_JOINT_NAME, &op_mode_handle));
 }
+
+TEST_F(TestRobotHardwareInterface, has_no_cycle_clock_by_default)
+{
+  EXPECT_EQ(hw::return_type::ERROR, robot_.wait_for_cycle());
+}
+
+TEST_F(TestRobotHardwareInterface, accepts_mode_switches_by_default)
+{
+  hw::ControllerSwitch controller_switch;
+  controller_switch.start_controllers.resize(1);
+  controller_switch.start_controllers[0].name = "effort_controller";
+  controller_switch.start_controllers[0].claimed_interfaces = {"joint_1/effort"};
+  EXPECT_EQ(hw::return_type::OK, robot_.prepare_mode_switch(controller_switch));
+  EXPECT_EQ(hw::return_type::OK, robot_.perform_mode_switch(controller_switch));
+}
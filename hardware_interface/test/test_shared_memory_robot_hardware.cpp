@@ -0,0 +1,255 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "hardware_interface/shared_memory_hardware_server.hpp"
+#include "hardware_interface/shared_memory_robot_hardware.hpp"
+#include "hardware_interface/types/hardware_interface_return_values.hpp"
+
+namespace hw = hardware_interface;
+using testing::ElementsAre;
+
+namespace
+{
+constexpr auto SEGMENT_NAME = "test_shared_memory_robot_hardware";
+
+/// Copies each command to its state, like a perfect position controlled robot
+class MyTestRobotHardware : public hw::RobotHardware
+{
+public:
+  hw::return_type init() override
+  {
+    register_joint("joint_1", "position", 1.0);
+    register_joint("joint_1", "position_command", 1.0);
+    register_actuator("actuator_1", "position", 2.0);
+    register_actuator("actuator_1", "position_command", 2.0);
+    register_sensor("sensor_1", "force", 3.0);
+    register_gpio("gpio_1", "output_command", 4.0);
+    return hw::return_type::OK;
+  }
+
+  hw::return_type read() override
+  {
+    hw::InterfaceSample sample;
+    sample.time = 42;
+    set_joint_sample("joint_1", sample);
+    return hw::return_type::OK;
+  }
+
+  hw::return_type write() override
+  {
+    hw::JointHandle joint_state("joint_1", "position");
+    hw::JointHandle joint_command("joint_1", "position_command");
+    get_joint_handle(joint_state);
+    get_joint_handle(joint_command);
+    joint_state.set_value(joint_command.get_value());
+    hw::ActuatorHandle actuator_state("actuator_1", "position");
+    hw::ActuatorHandle actuator_command("actuator_1", "position_command");
+    get_actuator_handle(actuator_state);
+    get_actuator_handle(actuator_command);
+    actuator_state.set_value(actuator_command.get_value());
+    return hw::return_type::OK;
+  }
+};
+}  // namespace
+
+class TestSharedMemoryRobotHardware : public testing::Test
+{
+protected:
+  void SetUp()
+  {
+    hardware_ = std::make_shared<MyTestRobotHardware>();
+    hardware_->init();
+    server_ = std::make_shared<hw::SharedMemoryHardwareServer>(hardware_, SEGMENT_NAME);
+    ASSERT_EQ(hw::return_type::OK, server_->init());
+    server_thread_ = std::thread([this]() {server_->run();});
+  }
+
+  void TearDown()
+  {
+    stop_server();
+  }
+
+  void stop_server()
+  {
+    if (server_thread_.joinable()) {
+      server_->stop();
+      server_thread_.join();
+    }
+  }
+
+  std::shared_ptr<MyTestRobotHardware> hardware_;
+  std::shared_ptr<hw::SharedMemoryHardwareServer> server_;
+  std::thread server_thread_;
+};
+
+TEST_F(TestSharedMemoryRobotHardware, registers_interfaces_of_the_server)
+{
+  hw::SharedMemoryRobotHardware proxy(SEGMENT_NAME);
+  ASSERT_EQ(hw::return_type::OK, proxy.init());
+  EXPECT_THAT(proxy.get_registered_joint_names(), ElementsAre("joint_1"));
+  EXPECT_THAT(
+    proxy.get_registered_joint_interface_names("joint_1"),
+    ElementsAre("position", "position_command"));
+  EXPECT_THAT(
+    proxy.get_registered_actuator_interface_names("actuator_1"),
+    ElementsAre("position", "position_command"));
+
+  ASSERT_EQ(hw::return_type::OK, proxy.read());
+  hw::JointHandle joint_state("joint_1", "position");
+  proxy.get_joint_handle(joint_state);
+  EXPECT_EQ(1.0, joint_state.get_value());
+  hw::SensorHandle sensor_state("sensor_1", "force");
+  ASSERT_EQ(hw::return_type::OK, proxy.get_sensor_handle(sensor_state));
+  EXPECT_EQ(3.0, sensor_state.get_value());
+  hw::GpioHandle gpio_command("gpio_1", "output_command");
+  ASSERT_EQ(hw::return_type::OK, proxy.get_gpio_handle(gpio_command));
+  EXPECT_EQ(4.0, gpio_command.get_value());
+
+  hw::SharedMemoryRobotHardware missing_proxy("missing_segment");
+  EXPECT_EQ(hw::return_type::ERROR, missing_proxy.init());
+}
+
+TEST_F(TestSharedMemoryRobotHardware, commands_come_back_as_states)
+{
+  hw::SharedMemoryRobotHardware proxy(SEGMENT_NAME);
+  ASSERT_EQ(hw::return_type::OK, proxy.init());
+  hw::JointHandle joint_state("joint_1", "position");
+  hw::JointHandle joint_command("joint_1", "position_command");
+  hw::ActuatorHandle actuator_state("actuator_1", "position");
+  hw::ActuatorHandle actuator_command("actuator_1", "position_command");
+  proxy.get_joint_handle(joint_state);
+  proxy.get_joint_handle(joint_command);
+  proxy.get_actuator_handle(actuator_state);
+  proxy.get_actuator_handle(actuator_command);
+
+  constexpr auto cycles = 1000;
+  ASSERT_EQ(hw::return_type::OK, proxy.read());
+  const auto start = std::chrono::steady_clock::now();
+  for (auto cycle = 0; cycle < cycles; ++cycle) {
+    joint_command.set_value(cycle);
+    actuator_command.set_value(-cycle);
+    ASSERT_EQ(hw::return_type::OK, proxy.write());
+    ASSERT_EQ(hw::return_type::OK, proxy.read());
+    ASSERT_EQ(cycle, joint_state.get_value());
+    ASSERT_EQ(-cycle, actuator_state.get_value());
+  }
+  EXPECT_EQ(42, joint_state.get_sample().time) << "Samples should come along with the states";
+  const auto round_trip = (std::chrono::steady_clock::now() - start) / cycles;
+  // 10 us on a real-time kernel, leaving room for loaded test machines
+  EXPECT_LT(round_trip, std::chrono::microseconds(500));
+  EXPECT_TRUE(proxy.is_server_alive());
+  EXPECT_TRUE(server_->is_client_alive());
+}
+
+TEST_F(TestSharedMemoryRobotHardware, detects_lost_server)
+{
+  hw::SharedMemoryRobotHardware::Options options;
+  options.timeout = std::chrono::milliseconds(5);
+  hw::SharedMemoryRobotHardware proxy(SEGMENT_NAME, options);
+  ASSERT_EQ(hw::return_type::OK, proxy.init());
+  ASSERT_EQ(hw::return_type::OK, proxy.read());
+
+  hw::JointHandle joint_state("joint_1", "position");
+  proxy.get_joint_handle(joint_state);
+  EXPECT_TRUE(joint_state.get_sample().valid);
+
+  stop_server();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(proxy.is_server_alive());
+  EXPECT_EQ(hw::return_type::OK, proxy.write());
+  EXPECT_EQ(hw::return_type::ERROR, proxy.read());
+  EXPECT_FALSE(joint_state.get_sample().valid);
+}
+
+TEST_F(TestSharedMemoryRobotHardware, flags_states_invalid_without_new_states)
+{
+  stop_server();
+  hw::SharedMemoryHardwareServer::Options server_options;
+  server_options.timeout = std::chrono::milliseconds(1);
+  hw::SharedMemoryHardwareServer server(hardware_, SEGMENT_NAME, server_options);
+  ASSERT_EQ(hw::return_type::OK, server.init());
+
+  hw::SharedMemoryRobotHardware::Options options;
+  options.timeout = std::chrono::milliseconds(50);
+  hw::SharedMemoryRobotHardware proxy(SEGMENT_NAME, options);
+  ASSERT_EQ(hw::return_type::OK, proxy.init());
+  ASSERT_EQ(hw::return_type::OK, proxy.read());
+  hw::JointHandle joint_state("joint_1", "position");
+  proxy.get_joint_handle(joint_state);
+  EXPECT_TRUE(joint_state.get_sample().valid);
+
+  // the server is alive but publishes nothing
+  EXPECT_EQ(hw::return_type::ERROR, proxy.read());
+  EXPECT_FALSE(joint_state.get_sample().valid);
+
+  server.run_once();
+  ASSERT_EQ(hw::return_type::OK, proxy.read());
+  EXPECT_TRUE(joint_state.get_sample().valid);
+}
+
+TEST_F(TestSharedMemoryRobotHardware, remaps_segment_of_restarted_server)
+{
+  hw::SharedMemoryRobotHardware::Options options;
+  options.timeout = std::chrono::milliseconds(5);
+  hw::SharedMemoryRobotHardware proxy(SEGMENT_NAME, options);
+  ASSERT_EQ(hw::return_type::OK, proxy.init());
+  ASSERT_EQ(hw::return_type::OK, proxy.read());
+  hw::JointHandle joint_state("joint_1", "position");
+  hw::JointHandle joint_command("joint_1", "position_command");
+  proxy.get_joint_handle(joint_state);
+  proxy.get_joint_handle(joint_command);
+
+  stop_server();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(hw::return_type::ERROR, proxy.read());
+  EXPECT_FALSE(joint_state.get_sample().valid);
+
+  server_ = std::make_shared<hw::SharedMemoryHardwareServer>(hardware_, SEGMENT_NAME);
+  ASSERT_EQ(hw::return_type::OK, server_->init());
+  server_thread_ = std::thread([this]() {server_->run();});
+  ASSERT_EQ(hw::return_type::OK, proxy.read());
+  EXPECT_TRUE(joint_state.get_sample().valid);
+  joint_command.set_value(5.0);
+  // the server may publish the states of a cycle without commands first
+  for (auto cycle = 0; cycle < 10 && joint_state.get_value() != 5.0; ++cycle) {
+    ASSERT_EQ(hw::return_type::OK, proxy.write());
+    ASSERT_EQ(hw::return_type::OK, proxy.read());
+  }
+  EXPECT_EQ(5.0, joint_state.get_value());
+}
+
+TEST_F(TestSharedMemoryRobotHardware, stops_writing_without_client)
+{
+  stop_server();
+  hw::SharedMemoryHardwareServer::Options options;
+  options.timeout = std::chrono::milliseconds(1);
+  hw::SharedMemoryHardwareServer server(hardware_, SEGMENT_NAME, options);
+  ASSERT_EQ(hw::return_type::OK, server.init());
+  EXPECT_EQ(hw::return_type::ERROR, server.run_once());
+  EXPECT_FALSE(server.is_client_alive());
+
+  hw::SharedMemoryRobotHardware proxy(SEGMENT_NAME);
+  ASSERT_EQ(hw::return_type::OK, proxy.init());
+  ASSERT_EQ(hw::return_type::OK, proxy.write());
+  EXPECT_EQ(hw::return_type::OK, server.run_once());
+  EXPECT_TRUE(server.is_client_alive());
+}
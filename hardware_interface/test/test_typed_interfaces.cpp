@@ -0,0 +1,122 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "hardware_interface/robot_hardware.hpp"
+
+namespace hw = hardware_interface;
+using testing::ElementsAre;
+
+namespace
+{
+constexpr auto DRIVE_NAME = "drive_1";
+constexpr auto SENSOR_NAME = "ft_sensor";
+
+class DummyRobotHardware : public hw::RobotHardware
+{
+  hw::return_type init() override
+  {
+    return hw::return_type::OK;
+  }
+
+  hw::return_type read() override
+  {
+    return hw::return_type::OK;
+  }
+
+  hw::return_type write() override
+  {
+    return hw::return_type::OK;
+  }
+};
+}  // namespace
+
+TEST(TestTypedInterfaces, registers_interfaces_of_each_type)
+{
+  DummyRobotHardware robot_hw;
+  auto & digital_io = robot_hw.get_typed_interfaces<std::uint8_t>();
+  auto & mode_words = robot_hw.get_typed_interfaces<std::int32_t>();
+  EXPECT_EQ(hw::return_type::OK, digital_io.register_interface(DRIVE_NAME, "enabled", 1));
+  EXPECT_EQ(hw::return_type::OK, mode_words.register_interface(DRIVE_NAME, "mode", 8));
+  EXPECT_EQ(hw::return_type::ERROR, digital_io.register_interface(DRIVE_NAME, "enabled"));
+  EXPECT_EQ(hw::return_type::ERROR, digital_io.register_interface("", "enabled"));
+  EXPECT_EQ(hw::return_type::ERROR, digital_io.register_interface(DRIVE_NAME, "io", 0, 0));
+
+  hw::UInt8Handle enabled(DRIVE_NAME, "enabled");
+  hw::Int32Handle mode(DRIVE_NAME, "mode");
+  EXPECT_FALSE(enabled);
+  EXPECT_ANY_THROW(enabled.get_value());
+  ASSERT_EQ(hw::return_type::OK, digital_io.get_handle(enabled));
+  ASSERT_EQ(hw::return_type::OK, mode_words.get_handle(mode));
+  EXPECT_EQ(1u, enabled.get_value());
+  EXPECT_EQ(8, mode.get_value());
+  mode.set_value(-1);
+  EXPECT_EQ(-1, mode_words.data()[0]);
+
+  hw::Int32Handle missing(DRIVE_NAME, "enabled");
+  EXPECT_EQ(hw::return_type::ERROR, mode_words.get_handle(missing));
+
+  // registering could move the values the handles point to
+  EXPECT_TRUE(digital_io.is_frozen());
+  EXPECT_EQ(hw::return_type::ERROR, digital_io.register_interface(DRIVE_NAME, "io"));
+  EXPECT_EQ(1u, enabled.get_value());
+}
+
+TEST(TestTypedInterfaces, accesses_bits_of_bit_fields)
+{
+  DummyRobotHardware robot_hw;
+  auto & registers = robot_hw.get_typed_interfaces<std::uint32_t>();
+  ASSERT_EQ(hw::return_type::OK, registers.register_interface(DRIVE_NAME, "status_word", 0x8));
+  hw::BitFieldHandle status_word(DRIVE_NAME, "status_word");
+  ASSERT_EQ(hw::return_type::OK, registers.get_handle(status_word));
+
+  EXPECT_TRUE(status_word.get_bit(3));
+  EXPECT_FALSE(status_word.get_bit(0));
+  status_word.set_bit(0, true);
+  status_word.set_bit(3, false);
+  status_word.set_bit(31, true);
+  EXPECT_EQ(0x80000001u, status_word.get_value());
+  EXPECT_THROW(status_word.get_bit(32), std::out_of_range);
+}
+
+TEST(TestTypedInterfaces, stores_arrays_contiguously)
+{
+  DummyRobotHardware robot_hw;
+  auto & arrays = robot_hw.get_typed_interfaces<double>();
+  ASSERT_EQ(hw::return_type::OK, arrays.register_interface(SENSOR_NAME, "wrench", 0.0, 6));
+  ASSERT_EQ(hw::return_type::OK, arrays.register_interface(SENSOR_NAME, "temperature", 20.0));
+  EXPECT_EQ(7u, arrays.size());
+  EXPECT_EQ(6u, arrays.get_registered_interfaces()[1].offset);
+
+  // as a driver would copy the values received from the bus
+  const std::vector<double> bus_values = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 36.6};
+  std::copy(bus_values.begin(), bus_values.end(), arrays.data());
+
+  hw::DoubleArrayHandle wrench(SENSOR_NAME, "wrench");
+  hw::DoubleArrayHandle temperature(SENSOR_NAME, "temperature");
+  ASSERT_EQ(hw::return_type::OK, arrays.get_handle(wrench));
+  ASSERT_EQ(hw::return_type::OK, arrays.get_handle(temperature));
+  EXPECT_EQ(6u, wrench.size());
+  EXPECT_THAT(
+    std::vector<double>(wrench.data(), wrench.data() + wrench.size()),
+    ElementsAre(1.0, 2.0, 3.0, 4.0, 5.0, 6.0));
+  EXPECT_DOUBLE_EQ(6.0, wrench.get_value(5));
+  EXPECT_THROW(wrench.get_value(6), std::out_of_range);
+  EXPECT_DOUBLE_EQ(36.6, temperature.get_value());
+}
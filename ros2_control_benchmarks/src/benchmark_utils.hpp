@@ -0,0 +1,221 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BENCHMARK_UTILS_HPP_
+#define BENCHMARK_UTILS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "controller_manager/controller_manager.hpp"
+#include "hardware_interface/robot_hardware.hpp"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ros2_control_benchmarks
+{
+
+/** \brief Options given as `--name value` on the command line */
+class Options
+{
+public:
+  /// Throws std::invalid_argument for anything else than `--name value` pairs
+  Options(int argc, char ** argv)
+  {
+    for (int i = 1; i < argc; ++i) {
+      if (std::strncmp(argv[i], "--", 2) != 0 || i + 1 == argc) {
+        throw std::invalid_argument(std::string("expected --name value, got ") + argv[i]);
+      }
+      values_[argv[i] + 2] = argv[i + 1];
+      ++i;
+    }
+  }
+
+  std::string get(const std::string & name, const std::string & default_value) const
+  {
+    const auto it = values_.find(name);
+    return it == values_.end() ? default_value : it->second;
+  }
+
+  double get(const std::string & name, double default_value) const
+  {
+    const auto it = values_.find(name);
+    return it == values_.end() ? default_value : std::stod(it->second);
+  }
+
+  /// Comma separated list of values
+  std::vector<std::string> get_list(
+    const std::string & name, const std::string & default_value) const
+  {
+    std::vector<std::string> list;
+    std::stringstream stream(get(name, default_value));
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+      if (!item.empty()) {
+        list.push_back(item);
+      }
+    }
+    return list;
+  }
+
+  std::vector<double> get_numbers(
+    const std::string & name, const std::string & default_value) const
+  {
+    std::vector<double> numbers;
+    for (const auto & item : get_list(name, default_value)) {
+      numbers.push_back(std::stod(item));
+    }
+    return numbers;
+  }
+
+private:
+  std::unordered_map<std::string, std::string> values_;
+};
+
+/// Give the calling thread a SCHED_FIFO priority, false if it isn't allowed
+inline bool set_thread_priority(int priority)
+{
+#ifndef _WIN32
+  if (priority > 0) {
+    sched_param sched_parameters;
+    sched_parameters.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &sched_parameters) == 0;
+  }
+#else
+  (void) priority;
+#endif
+  return true;
+}
+
+/** \brief Realtime loop reading the hardware, updating the default rate group and writing */
+class ControlLoop
+{
+public:
+  /**
+   * \param period Period of the cycles, 0 to run them back to back
+   * \param on_cycle Called after each write with the duration of the cycle and how late it
+   * started, in nanoseconds, may be empty
+   */
+  ControlLoop(
+    std::shared_ptr<controller_manager::ControllerManager> controller_manager,
+    std::shared_ptr<hardware_interface::RobotHardware> hardware,
+    std::chrono::nanoseconds period, int priority,
+    std::function<void(std::int64_t, std::int64_t)> on_cycle = nullptr)
+  {
+    thread_ = std::thread(
+      [this, controller_manager, hardware, period, priority, on_cycle]() {
+        priority_set_ = set_thread_priority(priority);
+        auto next_cycle = std::chrono::steady_clock::now();
+        while (running_) {
+          const auto start = std::chrono::steady_clock::now();
+          // spinning cycles are never late
+          const auto lateness =
+            period.count() ? start - next_cycle : std::chrono::steady_clock::duration::zero();
+          hardware->read();
+          controller_manager->update();
+          hardware->write();
+          if (on_cycle) {
+            on_cycle(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count(),
+              std::chrono::duration_cast<std::chrono::nanoseconds>(lateness).count());
+          }
+          if (period.count() == 0) {
+            // spinning, only leave room to the other threads of the core
+            std::this_thread::yield();
+            continue;
+          }
+          next_cycle += period;
+          const auto now = std::chrono::steady_clock::now();
+          if (next_cycle < now) {
+            next_cycle = now;
+          }
+          std::this_thread::sleep_until(next_cycle);
+        }
+      });
+  }
+
+  ~ControlLoop()
+  {
+    stop();
+  }
+
+  void stop()
+  {
+    running_ = false;
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  /// Whether the priority was applied, once the loop started
+  bool priority_set() const
+  {
+    return priority_set_;
+  }
+
+private:
+  std::atomic<bool> running_ {true};
+  std::atomic<bool> priority_set_ {true};
+  std::thread thread_;
+};
+
+/** \brief Threads competing with the control loop for the CPUs and their caches */
+class BackgroundLoad
+{
+public:
+  explicit BackgroundLoad(size_t thread_count)
+  {
+    for (size_t i = 0; i < thread_count; ++i) {
+      threads_.emplace_back(
+        [this]() {
+          // larger than the last level cache of most CPUs
+          std::vector<char> source(16 << 20, 1), destination(16 << 20);
+          while (running_) {
+            std::memcpy(destination.data(), source.data(), source.size());
+            // keeps the copy from being optimized away
+            source[0] = destination[source.size() / 2];
+          }
+        });
+    }
+  }
+
+  ~BackgroundLoad()
+  {
+    running_ = false;
+    for (auto & thread : threads_) {
+      thread.join();
+    }
+  }
+
+private:
+  std::atomic<bool> running_ {true};
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace ros2_control_benchmarks
+#endif  // BENCHMARK_UTILS_HPP_
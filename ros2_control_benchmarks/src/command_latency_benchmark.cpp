@@ -0,0 +1,253 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the latency of commands from their publisher to RobotHardware::write(), through the
+// subscription of a controller, its realtime buffer and its update(), for each combination of
+// executor, loop rate and background load given on the command line.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/controller_manager.hpp"
+#include "controller_manager_msgs/srv/switch_controller.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "std_msgs/msg/u_int64.hpp"
+
+#include "./benchmark_utils.hpp"
+#include "./command_latency_controller.hpp"
+#include "./command_latency_probe.hpp"
+#include "./latency_histogram.hpp"
+#include "./latency_robot_hardware.hpp"
+
+namespace
+{
+constexpr auto kControllerName = "command_latency_controller";
+constexpr auto kControllerType = "ros2_control_benchmarks/CommandLatencyController";
+constexpr auto kJointName = "joint1";
+constexpr auto kCommandInterface = "position_command";
+
+constexpr auto kUsage =
+  "usage: command_latency_benchmark [--name value]...\n"
+  "  --executors LIST     executors spinning the controller subscription, among\n"
+  "                       single, multi, static and dedicated (default: all of them)\n"
+  "  --rates LIST         control loop rates in Hz (default: 100,1000)\n"
+  "  --loads LIST         numbers of background threads copying memory (default: 0,2)\n"
+  "  --commands N         commands published per configuration (default: 1000)\n"
+  "  --publish_rate HZ    rate of the commands (default: 200)\n"
+  "  --priority P         SCHED_FIFO priority of the control loop, 0 for none (default: 0)\n"
+  "  --histogram BOOL     print the end to end histogram of each configuration (default: 1)\n";
+
+using ros2_control_benchmarks::CommandStage;
+using ros2_control_benchmarks::LatencyHistogram;
+
+struct Configuration
+{
+  std::string executor;
+  double rate;
+  size_t load;
+};
+
+std::shared_ptr<rclcpp::Executor> make_executor(const std::string & name)
+{
+  if (name == "multi") {
+    return std::make_shared<rclcpp::executors::MultiThreadedExecutor>();
+  }
+  if (name == "static") {
+    return std::make_shared<rclcpp::executors::StaticSingleThreadedExecutor>();
+  }
+  if (name == "single" || name == "dedicated") {
+    return std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  }
+  throw std::invalid_argument("unknown executor " + name);
+}
+
+/// Latency between two stages of every command which reached both
+LatencyHistogram measure(
+  const ros2_control_benchmarks::CommandLatencyProbe & probe, CommandStage from,
+  CommandStage to)
+{
+  LatencyHistogram histogram;
+  histogram.reserve(probe.max_sequence());
+  for (std::uint64_t sequence = 1; sequence <= probe.max_sequence(); ++sequence) {
+    const auto from_ns = probe.get(sequence, from);
+    const auto to_ns = probe.get(sequence, to);
+    if (from_ns && to_ns) {
+      histogram.record(to_ns - from_ns);
+    }
+  }
+  return histogram;
+}
+
+bool run(
+  const Configuration & configuration, std::uint64_t command_count, double publish_rate,
+  int priority, bool print_histogram)
+{
+  auto probe = std::make_shared<ros2_control_benchmarks::CommandLatencyProbe>(command_count);
+  auto hardware = std::make_shared<ros2_control_benchmarks::LatencyRobotHardware>(
+    probe, kJointName, kCommandInterface);
+  if (hardware->init() != hardware_interface::return_type::OK) {
+    std::fprintf(stderr, "failed to initialize the hardware\n");
+    return false;
+  }
+  auto executor = make_executor(configuration.executor);
+  auto controller_manager = std::make_shared<controller_manager::ControllerManager>(
+    hardware, executor, "latency_benchmark_controller_manager");
+  if (configuration.executor == "dedicated") {
+    // spun by a thread of the controller manager instead of the shared executor
+    controller_manager->set_parameter(
+      rclcpp::Parameter(std::string(kControllerName) + ".executor_group", "commands"));
+  }
+  auto controller = std::make_shared<ros2_control_benchmarks::CommandLatencyController>(
+    probe, kJointName, kCommandInterface);
+  if (!controller_manager->add_controller(controller, kControllerName, kControllerType)) {
+    std::fprintf(stderr, "failed to load the controller\n");
+    return false;
+  }
+  executor->add_node(controller_manager);
+  std::thread executor_thread([executor]() {executor->spin();});
+
+  auto publisher_node = std::make_shared<rclcpp::Node>("latency_benchmark_publisher");
+  auto publisher = publisher_node->create_publisher<std_msgs::msg::UInt64>(
+    std::string("/") + kControllerName + "/commands", rclcpp::SystemDefaultsQoS());
+
+  bool ok = true;
+  {
+    ros2_control_benchmarks::ControlLoop control_loop(
+      controller_manager, hardware,
+      std::chrono::nanoseconds(static_cast<std::int64_t>(1e9 / configuration.rate)), priority);
+    if (controller_manager->switch_controller(
+        {kControllerName}, {},
+        controller_manager_msgs::srv::SwitchController::Request::STRICT) !=
+      controller_interface::return_type::SUCCESS)
+    {
+      std::fprintf(stderr, "failed to start the controller\n");
+      ok = false;
+    }
+    const auto discovery_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (ok && publisher->get_subscription_count() == 0) {
+      if (std::chrono::steady_clock::now() > discovery_deadline) {
+        std::fprintf(stderr, "the controller didn't subscribe to the commands\n");
+        ok = false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (!control_loop.priority_set()) {
+      std::fprintf(stderr, "warning: could not set the priority of the control loop\n");
+    }
+
+    if (ok) {
+      ros2_control_benchmarks::BackgroundLoad load(configuration.load);
+      const auto publish_period =
+        std::chrono::nanoseconds(static_cast<std::int64_t>(1e9 / publish_rate));
+      auto next_publish = std::chrono::steady_clock::now();
+      std_msgs::msg::UInt64 msg;
+      for (std::uint64_t sequence = 1; sequence <= command_count; ++sequence) {
+        msg.data = sequence;
+        probe->stamp(sequence, CommandStage::PUBLISHED);
+        publisher->publish(msg);
+        next_publish += publish_period;
+        std::this_thread::sleep_until(next_publish);
+      }
+      // let the last command reach the hardware
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+      while (!probe->get(command_count, CommandStage::WRITTEN) &&
+        std::chrono::steady_clock::now() < deadline)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+  }
+  executor->cancel();
+  executor_thread.join();
+  if (!ok) {
+    return false;
+  }
+
+  std::printf(
+    "\nexecutor %s, loop rate %.0f Hz, %zu background threads\n",
+    configuration.executor.c_str(), configuration.rate, configuration.load);
+  LatencyHistogram::print_header(stdout, "stage");
+  const auto subscription = measure(*probe, CommandStage::PUBLISHED, CommandStage::RECEIVED);
+  const auto handoff = measure(*probe, CommandStage::RECEIVED, CommandStage::UPDATED);
+  const auto update = measure(*probe, CommandStage::UPDATED, CommandStage::WRITTEN);
+  const auto end_to_end = measure(*probe, CommandStage::PUBLISHED, CommandStage::WRITTEN);
+  subscription.print_row(stdout, "publish -> subscription");
+  handoff.print_row(stdout, "subscription -> update()");
+  update.print_row(stdout, "update() -> write()");
+  end_to_end.print_row(stdout, "publish -> write()");
+  // newer commands overwrite the ones not picked up yet by the control loop
+  std::printf(
+    "%llu of %llu commands reached write()\n",
+    static_cast<unsigned long long>(end_to_end.count()),
+    static_cast<unsigned long long>(command_count));
+  if (print_histogram) {
+    end_to_end.print_buckets(stdout);
+  }
+  return true;
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  const auto args = rclcpp::remove_ros_arguments(argc, argv);
+  std::vector<char *> arg_pointers;
+  for (const auto & arg : args) {
+    arg_pointers.push_back(const_cast<char *>(arg.c_str()));
+  }
+
+  std::vector<Configuration> configurations;
+  std::uint64_t command_count = 0;
+  double publish_rate = 0.0;
+  int priority = 0;
+  bool print_histogram = true;
+  try {
+    const ros2_control_benchmarks::Options options(
+      static_cast<int>(arg_pointers.size()), arg_pointers.data());
+    for (const auto & executor : options.get_list("executors", "single,multi,static,dedicated")) {
+      make_executor(executor);
+      for (const auto rate : options.get_numbers("rates", "100,1000")) {
+        for (const auto load : options.get_numbers("loads", "0,2")) {
+          configurations.push_back({executor, rate, static_cast<size_t>(load)});
+        }
+      }
+    }
+    command_count = static_cast<std::uint64_t>(options.get("commands", 1000.0));
+    publish_rate = options.get("publish_rate", 200.0);
+    priority = static_cast<int>(options.get("priority", 0.0));
+    print_histogram = options.get("histogram", 1.0) != 0.0;
+  } catch (const std::exception & e) {
+    std::fprintf(stderr, "%s\n%s", e.what(), kUsage);
+    rclcpp::shutdown();
+    return 1;
+  }
+
+  int ret = 0;
+  for (const auto & configuration : configurations) {
+    if (!rclcpp::ok()) {
+      break;
+    }
+    if (!run(configuration, command_count, publish_rate, priority, print_histogram)) {
+      ret = 1;
+    }
+  }
+  rclcpp::shutdown();
+  return ret;
+}
@@ -0,0 +1,68 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./command_latency_controller.hpp"
+
+#include <memory>
+#include <string>
+
+namespace ros2_control_benchmarks
+{
+
+CommandLatencyController::CommandLatencyController(
+  std::shared_ptr<CommandLatencyProbe> probe, const std::string & joint_name,
+  const std::string & interface_name)
+: controller_interface::ControllerInterface(),
+  probe_(probe),
+  command_handle_(joint_name, interface_name)
+{}
+
+controller_interface::return_type
+CommandLatencyController::update()
+{
+  if (commands_.update()) {
+    const auto sequence = commands_.read_buffer();
+    probe_->stamp(sequence, CommandStage::UPDATED);
+    command_handle_.set_value(static_cast<double>(sequence));
+  }
+  return controller_interface::return_type::SUCCESS;
+}
+
+rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
+CommandLatencyController::on_configure(const rclcpp_lifecycle::State & previous_state)
+{
+  (void) previous_state;
+  auto robot_hardware = robot_hardware_.lock();
+  if (!robot_hardware ||
+    robot_hardware->get_joint_handle(command_handle_) != hardware_interface::return_type::OK)
+  {
+    return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::ERROR;
+  }
+
+  auto on_command = [this](const std_msgs::msg::UInt64::SharedPtr msg) {
+      probe_->stamp(msg->data, CommandStage::RECEIVED);
+      commands_.write(msg->data);
+    };
+  // lightweight controllers only get a plain node
+  if (is_lightweight()) {
+    subscription_ = get_node()->create_subscription<std_msgs::msg::UInt64>(
+      "~/commands", rclcpp::SystemDefaultsQoS(), on_command);
+  } else {
+    subscription_ = get_lifecycle_node()->create_subscription<std_msgs::msg::UInt64>(
+      "~/commands", rclcpp::SystemDefaultsQoS(), on_command);
+  }
+  return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::SUCCESS;
+}
+
+}  // namespace ros2_control_benchmarks
@@ -0,0 +1,59 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef COMMAND_LATENCY_CONTROLLER_HPP_
+#define COMMAND_LATENCY_CONTROLLER_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "controller_interface/controller_interface.hpp"
+#include "controller_manager/triple_buffer.hpp"
+#include "hardware_interface/joint_handle.hpp"
+#include "std_msgs/msg/u_int64.hpp"
+
+#include "./command_latency_probe.hpp"
+
+namespace ros2_control_benchmarks
+{
+
+/** \brief Controller forwarding numbered commands from ~/commands to a joint command interface
+ *
+ * Stamps each command when the subscription receives it and when update() picks it up from
+ * the realtime buffer, like a controller taking commands from a topic would.
+ */
+class CommandLatencyController : public controller_interface::ControllerInterface
+{
+public:
+  CommandLatencyController(
+    std::shared_ptr<CommandLatencyProbe> probe, const std::string & joint_name,
+    const std::string & interface_name);
+
+  controller_interface::return_type
+  update() override;
+
+  rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
+  on_configure(const rclcpp_lifecycle::State & previous_state) override;
+
+private:
+  std::shared_ptr<CommandLatencyProbe> probe_;
+  hardware_interface::JointHandle command_handle_;
+  rclcpp::Subscription<std_msgs::msg::UInt64>::SharedPtr subscription_;
+  /// Last command received, handed to the RT thread
+  controller_manager::TripleBuffer<std::uint64_t> commands_ {0};
+};
+
+}  // namespace ros2_control_benchmarks
+#endif  // COMMAND_LATENCY_CONTROLLER_HPP_
@@ -0,0 +1,93 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef COMMAND_LATENCY_PROBE_HPP_
+#define COMMAND_LATENCY_PROBE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace ros2_control_benchmarks
+{
+
+/** Stages a command goes through, from its publisher to the hardware. */
+enum class CommandStage : std::uint8_t
+{
+  PUBLISHED = 0,
+  RECEIVED = 1,
+  UPDATED = 2,
+  WRITTEN = 3,
+};
+
+static constexpr size_t COMMAND_STAGE_COUNT = 4;
+
+/** \brief Time at which each command reached each stage
+ *
+ * Commands are numbered from 1, the number is the value sent down to the hardware.
+ * Stamping is a lock-free store into preallocated slots, so the RT thread can do it.
+ */
+class CommandLatencyProbe
+{
+public:
+  /// Room for the commands numbered 1 to \p max_sequence
+  explicit CommandLatencyProbe(std::uint64_t max_sequence)
+  : max_sequence_(max_sequence),
+    stamps_(new std::atomic<std::int64_t>[(max_sequence + 1) * COMMAND_STAGE_COUNT])
+  {
+    for (size_t i = 0; i < (max_sequence + 1) * COMMAND_STAGE_COUNT; ++i) {
+      stamps_[i] = 0;
+    }
+  }
+
+  static std::int64_t now_ns()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  std::uint64_t max_sequence() const
+  {
+    return max_sequence_;
+  }
+
+  /// Record the current time for a command and stage, only the first time it is reached
+  void stamp(std::uint64_t sequence, CommandStage stage)
+  {
+    if (sequence == 0 || sequence > max_sequence_) {
+      return;
+    }
+    std::int64_t unset = 0;
+    slot(sequence, stage).compare_exchange_strong(unset, now_ns());
+  }
+
+  /// Time a command reached a stage, 0 if it didn't
+  std::int64_t get(std::uint64_t sequence, CommandStage stage) const
+  {
+    return stamps_[sequence * COMMAND_STAGE_COUNT + static_cast<size_t>(stage)];
+  }
+
+private:
+  std::atomic<std::int64_t> & slot(std::uint64_t sequence, CommandStage stage)
+  {
+    return stamps_[sequence * COMMAND_STAGE_COUNT + static_cast<size_t>(stage)];
+  }
+
+  const std::uint64_t max_sequence_;
+  std::unique_ptr<std::atomic<std::int64_t>[]> stamps_;
+};
+
+}  // namespace ros2_control_benchmarks
+#endif  // COMMAND_LATENCY_PROBE_HPP_
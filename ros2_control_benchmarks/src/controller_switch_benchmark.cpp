@@ -0,0 +1,222 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures how long loading, starting, stopping and unloading a controller take depending on
+// the number of controllers already loaded, while a control loop keeps updating them, and how
+// much longer the cycles of the control loop get while these requests are applied.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "controller_manager/controller_manager.hpp"
+#include "controller_manager_msgs/srv/switch_controller.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rcutils/logging.h"
+#include "test_robot_hardware/test_robot_hardware.hpp"
+
+#include "./benchmark_utils.hpp"
+#include "./latency_histogram.hpp"
+#include "./noop_controller.hpp"
+
+namespace
+{
+constexpr auto kControllerType = "ros2_control_benchmarks/NoopController";
+constexpr auto kMeasuredControllerName = "measured_controller";
+constexpr auto STRICT = controller_manager_msgs::srv::SwitchController::Request::STRICT;
+// cycles recorded by the control loop of a run
+constexpr size_t kMaxCycles = 1 << 20;
+
+constexpr auto kUsage =
+  "usage: controller_switch_benchmark [--name value]...\n"
+  "  --counts LIST        numbers of controllers loaded and running (default: 1,10,50,100,200)\n"
+  "  --repetitions N      operations measured for each count (default: 50)\n"
+  "  --rate HZ            control loop rate, 0 to spin (default: 0)\n"
+  "  --priority P         SCHED_FIFO priority of the control loop, 0 for none (default: 0)\n"
+  "  --lightweight BOOL   load the controllers without their own node (default: 0)\n";
+
+using ros2_control_benchmarks::LatencyHistogram;
+
+/// Cycle durations of the control loop, apart for the cycles during a request
+struct CycleRecorder
+{
+  CycleRecorder()
+  {
+    idle.reserve(kMaxCycles);
+    busy.reserve(kMaxCycles);
+  }
+
+  /// Called from the control loop only
+  void record(std::int64_t duration_ns)
+  {
+    auto & cycles = request_pending ? busy : idle;
+    // never grows, not to allocate in the loop
+    if (cycles.count() < kMaxCycles) {
+      cycles.record(duration_ns);
+    }
+  }
+
+  std::atomic<bool> request_pending {false};
+  LatencyHistogram idle;
+  LatencyHistogram busy;
+};
+
+/// Time one request, marking the control cycles meanwhile as busy
+template<typename Function>
+bool measure(CycleRecorder & recorder, LatencyHistogram & histogram, Function && function)
+{
+  recorder.request_pending = true;
+  const auto start = std::chrono::steady_clock::now();
+  const bool ok = function();
+  histogram.record(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start).count());
+  recorder.request_pending = false;
+  return ok;
+}
+
+bool run(
+  size_t controller_count, size_t repetitions, double rate, int priority, bool lightweight)
+{
+  auto hardware = std::make_shared<test_robot_hardware::TestRobotHardware>();
+  if (hardware->init() != hardware_interface::return_type::OK) {
+    std::fprintf(stderr, "failed to initialize the hardware\n");
+    return false;
+  }
+  auto executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto controller_manager = std::make_shared<controller_manager::ControllerManager>(
+    hardware, executor, "switch_benchmark_controller_manager");
+  rcutils_logging_set_logger_level(
+    controller_manager->get_logger().get_name(), RCUTILS_LOG_SEVERITY_WARN);
+  controller_manager->set_parameter(rclcpp::Parameter("lightweight_controllers", lightweight));
+
+  CycleRecorder recorder;
+  ros2_control_benchmarks::ControlLoop control_loop(
+    controller_manager, hardware,
+    std::chrono::nanoseconds(rate > 0.0 ? static_cast<std::int64_t>(1e9 / rate) : 0), priority,
+    [&recorder](std::int64_t duration_ns, std::int64_t) {recorder.record(duration_ns);});
+
+  // the controllers already there, loaded and started at once
+  std::vector<std::string> names;
+  for (size_t i = 0; i < controller_count; ++i) {
+    names.push_back("controller_" + std::to_string(i));
+    if (!controller_manager->add_controller(
+        std::make_shared<ros2_control_benchmarks::NoopController>(), names.back(),
+        kControllerType))
+    {
+      std::fprintf(stderr, "failed to load %s\n", names.back().c_str());
+      return false;
+    }
+  }
+  if (controller_manager->switch_controller(names, {}, STRICT) !=
+    controller_interface::return_type::SUCCESS)
+  {
+    std::fprintf(stderr, "failed to start the controllers\n");
+    return false;
+  }
+  if (!control_loop.priority_set()) {
+    std::fprintf(stderr, "warning: could not set the priority of the control loop\n");
+  }
+
+  LatencyHistogram load, start, stop, unload;
+  for (auto histogram : {&load, &start, &stop, &unload}) {
+    histogram->reserve(repetitions);
+  }
+  const auto success = controller_interface::return_type::SUCCESS;
+  for (size_t i = 0; i < repetitions; ++i) {
+    // the controller is created beforehand, it's loading it which is measured
+    auto controller = std::make_shared<ros2_control_benchmarks::NoopController>();
+    auto load_controller = [&]() {
+        return controller_manager->add_controller(
+          controller, kMeasuredControllerName, kControllerType) != nullptr;
+      };
+    auto start_controller = [&]() {
+        return controller_manager->switch_controller(
+          {kMeasuredControllerName}, {}, STRICT) == success;
+      };
+    auto stop_controller = [&]() {
+        return controller_manager->switch_controller(
+          {}, {kMeasuredControllerName}, STRICT) == success;
+      };
+    auto unload_controller = [&]() {
+        return controller_manager->unload_controller(kMeasuredControllerName) == success;
+      };
+    if (!measure(recorder, load, load_controller) ||
+      !measure(recorder, start, start_controller) ||
+      !measure(recorder, stop, stop_controller) ||
+      !measure(recorder, unload, unload_controller))
+    {
+      std::fprintf(stderr, "failed to load, switch or unload %s\n", kMeasuredControllerName);
+      return false;
+    }
+  }
+  control_loop.stop();
+
+  std::printf("\n%zu controllers running\n", controller_count);
+  LatencyHistogram::print_header(stdout, "operation");
+  load.print_row(stdout, "load");
+  start.print_row(stdout, "switch (start)");
+  stop.print_row(stdout, "switch (stop)");
+  unload.print_row(stdout, "unload");
+  // the requests are applied by manage_switch() and the list swaps in the busy cycles
+  recorder.idle.print_row(stdout, "control cycle, idle");
+  recorder.busy.print_row(stdout, "control cycle, during requests");
+  return true;
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  const auto args = rclcpp::remove_ros_arguments(argc, argv);
+  std::vector<char *> arg_pointers;
+  for (const auto & arg : args) {
+    arg_pointers.push_back(const_cast<char *>(arg.c_str()));
+  }
+
+  std::vector<double> counts;
+  size_t repetitions = 0;
+  double rate = 0.0;
+  int priority = 0;
+  bool lightweight = false;
+  try {
+    const ros2_control_benchmarks::Options options(
+      static_cast<int>(arg_pointers.size()), arg_pointers.data());
+    counts = options.get_numbers("counts", "1,10,50,100,200");
+    repetitions = static_cast<size_t>(options.get("repetitions", 50.0));
+    rate = options.get("rate", 0.0);
+    priority = static_cast<int>(options.get("priority", 0.0));
+    lightweight = options.get("lightweight", 0.0) != 0.0;
+  } catch (const std::exception & e) {
+    std::fprintf(stderr, "%s\n%s", e.what(), kUsage);
+    rclcpp::shutdown();
+    return 1;
+  }
+
+  int ret = 0;
+  for (const auto count : counts) {
+    if (!rclcpp::ok()) {
+      break;
+    }
+    if (!run(static_cast<size_t>(count), repetitions, rate, priority, lightweight)) {
+      ret = 1;
+    }
+  }
+  rclcpp::shutdown();
+  return ret;
+}
@@ -0,0 +1,141 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATENCY_HISTOGRAM_HPP_
+#define LATENCY_HISTOGRAM_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace ros2_control_benchmarks
+{
+
+/** \brief Latencies of one measurement, reported as percentiles and as a histogram
+ *
+ * Samples are kept to compute exact percentiles, reserve() them before measuring so recording
+ * doesn't allocate.
+ */
+class LatencyHistogram
+{
+public:
+  void reserve(size_t count)
+  {
+    samples_.reserve(count);
+  }
+
+  void record(std::int64_t latency_ns)
+  {
+    samples_.push_back(latency_ns);
+    sorted_ = false;
+  }
+
+  void clear()
+  {
+    samples_.clear();
+  }
+
+  size_t count() const
+  {
+    return samples_.size();
+  }
+
+  /// Latency below which \p fraction of the samples are, 0 without samples
+  std::int64_t percentile(double fraction) const
+  {
+    if (samples_.empty()) {
+      return 0;
+    }
+    sort();
+    const auto rank = static_cast<size_t>(std::ceil(fraction * samples_.size()));
+    return samples_[std::min(samples_.size(), std::max<size_t>(rank, 1)) - 1];
+  }
+
+  std::int64_t max() const
+  {
+    return percentile(1.0);
+  }
+
+  double mean() const
+  {
+    if (samples_.empty()) {
+      return 0.0;
+    }
+    double sum = 0.0;
+    for (const auto sample : samples_) {
+      sum += static_cast<double>(sample);
+    }
+    return sum / static_cast<double>(samples_.size());
+  }
+
+  /// Header of the rows printed by print_row()
+  static void print_header(FILE * out, const char * label = "latency")
+  {
+    std::fprintf(
+      out, "%-32s %8s %9s %9s %9s %9s %9s %9s  (us)\n", label, "count", "mean", "p50", "p90",
+      "p99", "p99.9", "max");
+  }
+
+  void print_row(FILE * out, const std::string & name) const
+  {
+    std::fprintf(
+      out, "%-32s %8zu %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n", name.c_str(), count(),
+      mean() / 1e3, percentile(0.5) / 1e3, percentile(0.9) / 1e3, percentile(0.99) / 1e3,
+      percentile(0.999) / 1e3, max() / 1e3);
+  }
+
+  /// Count of samples in power of two buckets of microseconds, skipping the empty ones
+  void print_buckets(FILE * out) const
+  {
+    std::vector<size_t> buckets;
+    for (const auto sample : samples_) {
+      size_t bucket = 0;
+      for (std::int64_t us = sample / 1000; us > 0; us /= 2) {
+        ++bucket;
+      }
+      if (bucket >= buckets.size()) {
+        buckets.resize(bucket + 1, 0);
+      }
+      ++buckets[bucket];
+    }
+    for (size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+      if (buckets[bucket] == 0) {
+        continue;
+      }
+      const long long low = bucket == 0 ? 0 : 1ll << (bucket - 1);
+      std::fprintf(
+        out, "  %8lld - %8lld us %8zu %s\n", low, 1ll << bucket, buckets[bucket],
+        std::string(buckets[bucket] * 50 / samples_.size(), '#').c_str());
+    }
+  }
+
+private:
+  void sort() const
+  {
+    if (!sorted_) {
+      std::sort(samples_.begin(), samples_.end());
+      sorted_ = true;
+    }
+  }
+
+  // sorted lazily by the const accessors
+  mutable std::vector<std::int64_t> samples_;
+  mutable bool sorted_ = true;
+};
+
+}  // namespace ros2_control_benchmarks
+#endif  // LATENCY_HISTOGRAM_HPP_
@@ -0,0 +1,53 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./latency_robot_hardware.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace ros2_control_benchmarks
+{
+
+LatencyRobotHardware::LatencyRobotHardware(
+  std::shared_ptr<CommandLatencyProbe> probe, const std::string & joint_name,
+  const std::string & interface_name)
+: probe_(probe),
+  command_handle_(joint_name, interface_name)
+{}
+
+hardware_interface::return_type
+LatencyRobotHardware::init()
+{
+  const auto ret = TestRobotHardware::init();
+  if (ret != hardware_interface::return_type::OK) {
+    return ret;
+  }
+  return get_joint_handle(command_handle_);
+}
+
+hardware_interface::return_type
+LatencyRobotHardware::write()
+{
+  // commands are whole numbers, unlike the default values of the test hardware
+  const double command = command_handle_.get_value();
+  if (command >= 1.0 && command == std::floor(command)) {
+    probe_->stamp(static_cast<std::uint64_t>(command), CommandStage::WRITTEN);
+  }
+  return TestRobotHardware::write();
+}
+
+}  // namespace ros2_control_benchmarks
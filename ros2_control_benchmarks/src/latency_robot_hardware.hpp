@@ -0,0 +1,49 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATENCY_ROBOT_HARDWARE_HPP_
+#define LATENCY_ROBOT_HARDWARE_HPP_
+
+#include <memory>
+#include <string>
+
+#include "hardware_interface/joint_handle.hpp"
+#include "test_robot_hardware/test_robot_hardware.hpp"
+
+#include "./command_latency_probe.hpp"
+
+namespace ros2_control_benchmarks
+{
+
+/** \brief TestRobotHardware stamping the numbered command it sees in each write() */
+class LatencyRobotHardware : public test_robot_hardware::TestRobotHardware
+{
+public:
+  LatencyRobotHardware(
+    std::shared_ptr<CommandLatencyProbe> probe, const std::string & joint_name,
+    const std::string & interface_name);
+
+  hardware_interface::return_type
+  init() override;
+
+  hardware_interface::return_type
+  write() override;
+
+private:
+  std::shared_ptr<CommandLatencyProbe> probe_;
+  hardware_interface::JointHandle command_handle_;
+};
+
+}  // namespace ros2_control_benchmarks
+#endif  // LATENCY_ROBOT_HARDWARE_HPP_
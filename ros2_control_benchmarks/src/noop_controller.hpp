@@ -0,0 +1,39 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NOOP_CONTROLLER_HPP_
+#define NOOP_CONTROLLER_HPP_
+
+#include <cstdint>
+
+#include "controller_interface/controller_interface.hpp"
+
+namespace ros2_control_benchmarks
+{
+
+/** \brief Controller doing nothing but counting its updates, to fill the controller lists */
+class NoopController : public controller_interface::ControllerInterface
+{
+public:
+  controller_interface::return_type
+  update() override;
+
+  rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
+  on_configure(const rclcpp_lifecycle::State & previous_state) override;
+
+  std::uint64_t update_count = 0;
+};
+
+}  // namespace ros2_control_benchmarks
+#endif  // NOOP_CONTROLLER_HPP_
@@ -0,0 +1,477 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs the controller manager for hours while randomly loading, switching and unloading
+// controllers, writing one line of cycle time, memory and page fault statistics per interval,
+// and fails if they drifted past the given thresholds by the end of the run.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/controller_manager.hpp"
+#include "controller_manager_msgs/srv/switch_controller.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rcutils/logging.h"
+#include "test_robot_hardware/test_robot_hardware.hpp"
+
+#include "./benchmark_utils.hpp"
+#include "./noop_controller.hpp"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+std::atomic<std::uint64_t> g_allocations {0};
+std::atomic<std::uint64_t> g_control_loop_allocations {0};
+// set by the control loop thread on its first cycle
+thread_local bool t_control_loop_thread = false;
+}  // namespace
+
+// counts every allocation of the process, the other forms of new end up here
+void * operator new(std::size_t size)
+{
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (t_control_loop_thread) {
+    g_control_loop_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (void * pointer = std::malloc(size ? size : 1)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void * pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete(void * pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+
+namespace
+{
+constexpr auto kControllerType = "ros2_control_benchmarks/NoopController";
+constexpr auto STRICT = controller_manager_msgs::srv::SwitchController::Request::STRICT;
+
+constexpr auto kUsage =
+  "usage: soak_test [--name value]...\n"
+  "  --duration S             length of the run in seconds (default: 3600)\n"
+  "  --controllers N          controllers randomly loaded, switched and unloaded (default: 50)\n"
+  "  --rate HZ                control loop rate (default: 1000)\n"
+  "  --priority P             SCHED_FIFO priority of the control loop, 0 for none (default: 0)\n"
+  "  --operation_period MS    time between two random operations (default: 100)\n"
+  "  --interval S             time between two lines of statistics (default: 10)\n"
+  "  --output FILE            statistics written along the run (default: soak_test.csv)\n"
+  "  --seed N                 seed of the random operations (default: 0)\n"
+  "  --warmup S               time for the controller lists to fill up, the thresholds are\n"
+  "                           checked against the first interval after it (default: 60)\n"
+  "Thresholds, from the first interval after the warmup to the last one, negative to disable\n"
+  "them:\n"
+  "  --max_rss_growth_kb KB   growth of the resident memory (default: 10240)\n"
+  "  --max_p99_growth RATIO   growth of the 99th percentile of the cycle time and of the\n"
+  "                           wake up latency (default: 4)\n"
+  "  --max_cycle_us US        longest cycle of the whole run (default: -1)\n"
+  "  --max_control_loop_allocations_per_cycle N\n"
+  "                           allocations of the control loop thread, which include the ones\n"
+  "                           of the test hardware and controllers (default: -1)\n";
+
+/** \brief Durations in power of two buckets of microseconds, recorded without allocating */
+class CycleHistogram
+{
+public:
+  static constexpr size_t BUCKET_COUNT = 24;
+  using Counts = std::array<std::uint64_t, BUCKET_COUNT>;
+
+  /// Called from the control loop only
+  void record(std::int64_t duration_ns)
+  {
+    size_t bucket = 0;
+    for (std::int64_t us = duration_ns / 1000; us > 0 && bucket + 1 < BUCKET_COUNT; us /= 2) {
+      ++bucket;
+    }
+    counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+    if (duration_ns > max_ns_.load(std::memory_order_relaxed)) {
+      max_ns_.store(duration_ns, std::memory_order_relaxed);
+    }
+  }
+
+  /// Counts and longest cycle since the previous call
+  void take(Counts & counts, std::int64_t & max_ns)
+  {
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+      counts[i] = counts_[i].exchange(0, std::memory_order_relaxed);
+    }
+    max_ns = max_ns_.exchange(0, std::memory_order_relaxed);
+  }
+
+  /// Upper bound of the bucket holding the given fraction of the cycles, in microseconds
+  static std::int64_t percentile_us(const Counts & counts, double fraction)
+  {
+    std::uint64_t total = 0;
+    for (const auto count : counts) {
+      total += count;
+    }
+    std::uint64_t cumulated = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+      cumulated += counts[i];
+      if (total > 0 && cumulated >= fraction * total) {
+        return 1ll << i;
+      }
+    }
+    return 0;
+  }
+
+private:
+  std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> counts_ {};
+  std::atomic<std::int64_t> max_ns_ {0};
+};
+
+struct Sample
+{
+  double time_s = 0.0;
+  std::uint64_t cycles = 0;
+  std::int64_t p50_us = 0;
+  std::int64_t p99_us = 0;
+  std::int64_t p999_us = 0;
+  double max_us = 0.0;
+  std::int64_t latency_p99_us = 0;
+  double latency_max_us = 0.0;
+  long rss_kb = 0;
+  std::uint64_t allocations = 0;
+  std::uint64_t control_loop_allocations = 0;
+  long minor_faults = 0;
+  long major_faults = 0;
+};
+
+/// Resident memory of the process, 0 if unknown
+long get_rss_kb()
+{
+  long rss_kb = 0;
+#ifdef __linux__
+  if (FILE * statm = std::fopen("/proc/self/statm", "r")) {
+    long size = 0, resident = 0;
+    if (std::fscanf(statm, "%ld %ld", &size, &resident) == 2) {
+      rss_kb = resident * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+    std::fclose(statm);
+  }
+#endif
+  return rss_kb;
+}
+
+void get_page_faults(long & minor_faults, long & major_faults)
+{
+  minor_faults = major_faults = 0;
+#ifndef _WIN32
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    minor_faults = usage.ru_minflt;
+    major_faults = usage.ru_majflt;
+  }
+#endif
+}
+
+/** \brief Controllers of the run and the state the soak test put them in */
+class ControllerPool
+{
+public:
+  ControllerPool(
+    std::shared_ptr<controller_manager::ControllerManager> controller_manager, size_t size,
+    unsigned int seed)
+  : controller_manager_(controller_manager), states_(size, State::UNLOADED), random_(seed)
+  {}
+
+  /// Loads, starts, stops or unloads a random controller, false if the request failed
+  bool random_operation()
+  {
+    const size_t index = std::uniform_int_distribution<size_t>(0, states_.size() - 1)(random_);
+    const std::string name = "soak_controller_" + std::to_string(index);
+    const auto success = controller_interface::return_type::SUCCESS;
+    switch (states_[index]) {
+      case State::UNLOADED:
+        if (!controller_manager_->add_controller(
+            std::make_shared<ros2_control_benchmarks::NoopController>(), name, kControllerType))
+        {
+          return false;
+        }
+        states_[index] = State::STOPPED;
+        return true;
+      case State::STOPPED:
+        if (std::bernoulli_distribution(0.5)(random_)) {
+          if (controller_manager_->unload_controller(name) != success) {
+            return false;
+          }
+          states_[index] = State::UNLOADED;
+          return true;
+        }
+        if (controller_manager_->switch_controller({name}, {}, STRICT) != success) {
+          return false;
+        }
+        states_[index] = State::RUNNING;
+        return true;
+      case State::RUNNING:
+        if (controller_manager_->switch_controller({}, {name}, STRICT) != success) {
+          return false;
+        }
+        states_[index] = State::STOPPED;
+        return true;
+    }
+    return false;
+  }
+
+private:
+  enum class State {UNLOADED, STOPPED, RUNNING};
+
+  std::shared_ptr<controller_manager::ControllerManager> controller_manager_;
+  std::vector<State> states_;
+  std::mt19937 random_;
+};
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  const auto args = rclcpp::remove_ros_arguments(argc, argv);
+  std::vector<char *> arg_pointers;
+  for (const auto & arg : args) {
+    arg_pointers.push_back(const_cast<char *>(arg.c_str()));
+  }
+
+  double duration_s = 0.0, rate = 0.0, operation_period_ms = 0.0, interval_s = 0.0;
+  double warmup_s = 0.0;
+  double max_rss_growth_kb = 0.0, max_p99_growth = 0.0, max_cycle_us = 0.0;
+  double max_control_loop_allocations_per_cycle = 0.0;
+  size_t controller_count = 0;
+  int priority = 0;
+  unsigned int seed = 0;
+  std::string output_path;
+  try {
+    const ros2_control_benchmarks::Options options(
+      static_cast<int>(arg_pointers.size()), arg_pointers.data());
+    duration_s = options.get("duration", 3600.0);
+    controller_count = static_cast<size_t>(options.get("controllers", 50.0));
+    rate = options.get("rate", 1000.0);
+    priority = static_cast<int>(options.get("priority", 0.0));
+    operation_period_ms = options.get("operation_period", 100.0);
+    interval_s = options.get("interval", 10.0);
+    warmup_s = options.get("warmup", 60.0);
+    output_path = options.get("output", "soak_test.csv");
+    seed = static_cast<unsigned int>(options.get("seed", 0.0));
+    max_rss_growth_kb = options.get("max_rss_growth_kb", 10240.0);
+    max_p99_growth = options.get("max_p99_growth", 4.0);
+    max_cycle_us = options.get("max_cycle_us", -1.0);
+    max_control_loop_allocations_per_cycle =
+      options.get("max_control_loop_allocations_per_cycle", -1.0);
+    if (controller_count == 0 || rate <= 0.0 || operation_period_ms <= 0.0 ||
+      interval_s <= 0.0)
+    {
+      throw std::invalid_argument(
+        "controllers, rate, operation_period and interval must be positive");
+    }
+  } catch (const std::exception & e) {
+    std::fprintf(stderr, "%s\n%s", e.what(), kUsage);
+    rclcpp::shutdown();
+    return 1;
+  }
+
+  FILE * output = std::fopen(output_path.c_str(), "w");
+  if (!output) {
+    std::fprintf(stderr, "cannot write %s\n", output_path.c_str());
+    rclcpp::shutdown();
+    return 1;
+  }
+  std::fprintf(
+    output, "time_s,cycles,p50_us,p99_us,p999_us,max_us,latency_p99_us,latency_max_us,rss_kb,"
+    "allocations,"
+    "control_loop_allocations,minor_faults,major_faults,operations,failed_operations,"
+    "cycle_histogram\n");
+
+  auto hardware = std::make_shared<test_robot_hardware::TestRobotHardware>();
+  if (hardware->init() != hardware_interface::return_type::OK) {
+    std::fprintf(stderr, "failed to initialize the hardware\n");
+    rclcpp::shutdown();
+    return 1;
+  }
+  auto executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto controller_manager = std::make_shared<controller_manager::ControllerManager>(
+    hardware, executor, "soak_test_controller_manager");
+  rcutils_logging_set_logger_level(
+    controller_manager->get_logger().get_name(), RCUTILS_LOG_SEVERITY_WARN);
+  ControllerPool pool(controller_manager, controller_count, seed);
+
+  CycleHistogram cycle_histogram;
+  // how late the cycles start
+  CycleHistogram latency_histogram;
+  std::vector<Sample> samples;
+  std::uint64_t operations = 0, failed_operations = 0;
+  {
+    ros2_control_benchmarks::ControlLoop control_loop(
+      controller_manager, hardware,
+      std::chrono::nanoseconds(static_cast<std::int64_t>(1e9 / rate)), priority,
+      [&cycle_histogram, &latency_histogram](std::int64_t duration_ns, std::int64_t lateness_ns) {
+        t_control_loop_thread = true;
+        cycle_histogram.record(duration_ns);
+        latency_histogram.record(lateness_ns);
+      });
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + std::chrono::nanoseconds(static_cast<std::int64_t>(duration_s * 1e9));
+    const auto operation_period =
+      std::chrono::nanoseconds(static_cast<std::int64_t>(operation_period_ms * 1e6));
+    const auto interval = std::chrono::nanoseconds(static_cast<std::int64_t>(interval_s * 1e9));
+    auto next_operation = start;
+    auto next_sample = start + interval;
+    while (rclcpp::ok() && next_sample <= end) {
+      if (next_operation < next_sample) {
+        std::this_thread::sleep_until(next_operation);
+        ++operations;
+        if (!pool.random_operation()) {
+          ++failed_operations;
+        }
+        next_operation += operation_period;
+        continue;
+      }
+      std::this_thread::sleep_until(next_sample);
+      next_sample += interval;
+
+      Sample sample;
+      CycleHistogram::Counts counts;
+      std::int64_t max_ns = 0;
+      cycle_histogram.take(counts, max_ns);
+      for (const auto count : counts) {
+        sample.cycles += count;
+      }
+      sample.time_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      sample.p50_us = CycleHistogram::percentile_us(counts, 0.5);
+      sample.p99_us = CycleHistogram::percentile_us(counts, 0.99);
+      sample.p999_us = CycleHistogram::percentile_us(counts, 0.999);
+      sample.max_us = max_ns / 1e3;
+      CycleHistogram::Counts latency_counts;
+      latency_histogram.take(latency_counts, max_ns);
+      sample.latency_p99_us = CycleHistogram::percentile_us(latency_counts, 0.99);
+      sample.latency_max_us = max_ns / 1e3;
+      sample.rss_kb = get_rss_kb();
+      sample.allocations = g_allocations.exchange(0);
+      sample.control_loop_allocations = g_control_loop_allocations.exchange(0);
+      get_page_faults(sample.minor_faults, sample.major_faults);
+      samples.push_back(sample);
+
+      std::string histogram;
+      for (size_t i = 0; i < counts.size(); ++i) {
+        histogram += (i ? " " : "") + std::to_string(counts[i]);
+      }
+      std::fprintf(
+        output, "%.1f,%llu,%lld,%lld,%lld,%.1f,%lld,%.1f,%ld,%llu,%llu,%ld,%ld,%llu,%llu,%s\n",
+        sample.time_s, static_cast<unsigned long long>(sample.cycles),
+        static_cast<long long>(sample.p50_us), static_cast<long long>(sample.p99_us),
+        static_cast<long long>(sample.p999_us), sample.max_us,
+        static_cast<long long>(sample.latency_p99_us), sample.latency_max_us, sample.rss_kb,
+        static_cast<unsigned long long>(sample.allocations),
+        static_cast<unsigned long long>(sample.control_loop_allocations),
+        sample.minor_faults, sample.major_faults,
+        static_cast<unsigned long long>(operations),
+        static_cast<unsigned long long>(failed_operations), histogram.c_str());
+      // keep what was measured if the run is killed
+      std::fflush(output);
+    }
+    if (!control_loop.priority_set()) {
+      std::fprintf(stderr, "warning: could not set the priority of the control loop\n");
+    }
+  }
+  std::fclose(output);
+  rclcpp::shutdown();
+
+  const auto first_it = std::find_if(
+    samples.begin(), samples.end(),
+    [warmup_s](const Sample & sample) {return sample.time_s >= warmup_s;});
+  if (first_it == samples.end() || first_it + 1 == samples.end()) {
+    std::fprintf(stderr, "the run is too short to compare intervals after the warmup\n");
+    return 1;
+  }
+  const auto & first = *first_it;
+  const auto & last = samples.back();
+  std::printf(
+    "%zu intervals, %llu operations (%llu failed)\n"
+    "cycle p99: %lld us after the warmup, %lld us in the last interval\n"
+    "wake up latency p99: %lld us after the warmup, %lld us in the last interval\n"
+    "resident memory: %ld kB after the warmup, %ld kB in the last interval\n",
+    samples.size(), static_cast<unsigned long long>(operations),
+    static_cast<unsigned long long>(failed_operations), static_cast<long long>(first.p99_us),
+    static_cast<long long>(last.p99_us), static_cast<long long>(first.latency_p99_us),
+    static_cast<long long>(last.latency_p99_us), first.rss_kb, last.rss_kb);
+
+  bool passed = true;
+  if (failed_operations > 0) {
+    std::printf(
+      "FAILED: %llu operations failed\n", static_cast<unsigned long long>(failed_operations));
+    passed = false;
+  }
+  if (max_rss_growth_kb >= 0.0 && last.rss_kb - first.rss_kb > max_rss_growth_kb) {
+    std::printf("FAILED: resident memory grew by %ld kB\n", last.rss_kb - first.rss_kb);
+    passed = false;
+  }
+  if (max_p99_growth >= 0.0 && last.p99_us > max_p99_growth * first.p99_us) {
+    std::printf(
+      "FAILED: cycle p99 grew from %lld us to %lld us\n",
+      static_cast<long long>(first.p99_us), static_cast<long long>(last.p99_us));
+    passed = false;
+  }
+  if (max_p99_growth >= 0.0 && last.latency_p99_us > max_p99_growth * first.latency_p99_us) {
+    std::printf(
+      "FAILED: wake up latency p99 grew from %lld us to %lld us\n",
+      static_cast<long long>(first.latency_p99_us), static_cast<long long>(last.latency_p99_us));
+    passed = false;
+  }
+  for (const auto & sample : samples) {
+    // including the warmup, a long cycle is never expected
+    if (max_cycle_us >= 0.0 && sample.max_us > max_cycle_us) {
+      std::printf("FAILED: a cycle took %.1f us at %.0f s\n", sample.max_us, sample.time_s);
+      passed = false;
+      break;
+    }
+  }
+  for (const auto & sample : samples) {
+    if (max_control_loop_allocations_per_cycle >= 0.0 && sample.cycles > 0 &&
+      sample.control_loop_allocations >
+      max_control_loop_allocations_per_cycle * sample.cycles)
+    {
+      std::printf(
+        "FAILED: the control loop allocated %llu times in %llu cycles at %.0f s\n",
+        static_cast<unsigned long long>(sample.control_loop_allocations),
+        static_cast<unsigned long long>(sample.cycles), sample.time_s);
+      passed = false;
+      break;
+    }
+  }
+  std::printf("%s\n", passed ? "PASSED" : "FAILED");
+  return passed ? 0 : 1;
+}
@@ -56,10 +56,10 @@ public:
   std::vector<double> vel_dflt_values = {1.2, 2.2, 3.2};
   std::vector<double> eff_dflt_values = {1.3, 2.3, 3.3};
 
-  bool read1 = false;
-  bool read2 = false;
-  bool write1 = false;
-  bool write2 = false;
+  hardware_interface::OperationMode read1 = hardware_interface::OperationMode::INACTIVE;
+  hardware_interface::OperationMode read2 = hardware_interface::OperationMode::INACTIVE;
+  hardware_interface::OperationMode write1 = hardware_interface::OperationMode::INACTIVE;
+  hardware_interface::OperationMode write2 = hardware_interface::OperationMode::INACTIVE;
 
   hardware_interface::OperationModeHandle read_op_handle1;
   hardware_interface::OperationModeHandle read_op_handle2;
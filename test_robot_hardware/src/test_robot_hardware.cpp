@@ -26,36 +26,28 @@ TestRobotHardware::init()
 {
   auto ret = hardware_interface::return_type::ERROR;
 
-  read_op_handle1 = hardware_interface::OperationModeHandle(
-    read_op_handle_name1,
-    reinterpret_cast<hardware_interface::OperationMode *>(&read1));
+  read_op_handle1 = hardware_interface::OperationModeHandle(read_op_handle_name1, &read1);
   ret = register_operation_mode_handle(&read_op_handle1);
   if (ret != hardware_interface::return_type::OK) {
     RCLCPP_WARN(logger, "can't register operation mode handle %s", read_op_handle_name1.c_str());
     return ret;
   }
 
-  read_op_handle2 = hardware_interface::OperationModeHandle(
-    read_op_handle_name2,
-    reinterpret_cast<hardware_interface::OperationMode *>(&read2));
+  read_op_handle2 = hardware_interface::OperationModeHandle(read_op_handle_name2, &read2);
   ret = register_operation_mode_handle(&read_op_handle2);
   if (ret != hardware_interface::return_type::OK) {
     RCLCPP_WARN(logger, "can't register operation mode handle %s", read_op_handle_name2.c_str());
     return ret;
   }
 
-  write_op_handle1 = hardware_interface::OperationModeHandle(
-    write_op_handle_name1,
-    reinterpret_cast<hardware_interface::OperationMode *>(&write1));
+  write_op_handle1 = hardware_interface::OperationModeHandle(write_op_handle_name1, &write1);
   ret = register_operation_mode_handle(&write_op_handle1);
   if (ret != hardware_interface::return_type::OK) {
     RCLCPP_WARN(logger, "can't register operation mode handle %s", write_op_handle_name1.c_str());
     return ret;
   }
 
-  write_op_handle2 = hardware_interface::OperationModeHandle(
-    write_op_handle_name2,
-    reinterpret_cast<hardware_interface::OperationMode *>(&write2));
+  write_op_handle2 = hardware_interface::OperationModeHandle(write_op_handle_name2, &write2);
   ret = register_operation_mode_handle(&write_op_handle2);
   if (ret != hardware_interface::return_type::OK) {
     RCLCPP_WARN(logger, "can't register operation mode handle %s", write_op_handle_name2.c_str());